@@ -38,7 +38,9 @@ $objs = %w{ rbclutter.o rbcltactor.o rbcltalpha.o rbcltbehaviour.o rbcltbehaviou
 + %w{ rbcltstagemanager.o rbcltchildmeta.o rbcltscript.o rbcltscore.o } \
 + %w{ rbcltlistmodel.o rbcltmodel.o rbcltpath.o rbcltcairotexture.o } \
 + %w{ rbcltinterval.o rbcltanimation.o rbclttext.o rbcltanimatable.o } \
-+ %w{ rbcltfixedlayout.o }
++ %w{ rbcltfixedlayout.o rbcltstats.o rbcltcurve.o } \
++ %w{ rbclttimelinegroup.o rbcltcolumnarmodel.o rbcltlistview.o } \
++ %w{ rbcltspatialindex.o rbcltstagecapture.o rbcltoffscreenrenderer.o }
 
 $objs += %w{ rbclteffects.o }
 
@@ -47,9 +49,9 @@ $objs += %w{ rbclteffects.o }
 $objs += %w{ rbcogl.o rbcogltexture.o rbcoglprimitives.o } \
 + %w{ rbcoglshader.o rbcoglprogram.o rbcogloffscreen.o rbcoglmatrix.o } \
 + %w{ rbcoglhandle.o rbcoglcolor.o rbcoglmaterial.o rbcoglbitmap.o } \
-+ %w{ rbcoglvertexbuffer.o }
++ %w{ rbcoglattributearray.o rbcoglvertexlayout.o rbcoglvertexbuffer.o }
 
-$objs += %w(rbcoglclip.o rbcoglvector3.o)
+$objs += %w(rbcoglclip.o rbcoglvector3.o rbcoglmatrixarray.o)
 
 # Add the boxed types to the object files list
 BOXED_TYPES.each { |bt| $objs << "rbclt#{bt}.o" }
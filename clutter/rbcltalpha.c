@@ -23,6 +23,8 @@
 
 #include "rbclutter.h"
 #include "rbcltcallbackfunc.h"
+#include "rbcltstats.h"
+#include "rbcltcurve.h"
 
 static ID id_call;
 
@@ -30,8 +32,14 @@ static gdouble
 rbclt_alpha_proc_invoke (ClutterAlpha *alpha, RBCLTCallbackFunc *callback)
 {
   VALUE alpha_value = GOBJ2RVAL (alpha);
+  gdouble start = rbclt_stats_begin ();
+  gdouble ret;
 
-  return NUM2DBL (rbclt_callback_func_invoke (callback, 1, &alpha_value));
+  ret = NUM2DBL (rbclt_callback_func_invoke (callback, 1, &alpha_value));
+
+  rbclt_stats_end (RBCLT_STATS_ALPHA, start);
+
+  return ret;
 }
 
 static GClosure *
@@ -48,13 +56,85 @@ rbclt_alpha_proc_to_closure (VALUE proc)
                          (GClosureNotify) rbclt_callback_func_destroy);
 }
 
+typedef struct _SampleData SampleData;
+
+struct _SampleData
+{
+  ClutterTimeline *timeline;
+  ClutterAlpha *alpha;
+  guint n_samples;
+  gdouble *values;
+};
+
+static VALUE
+rbclt_alpha_do_sample (VALUE data_value)
+{
+  SampleData *data = (SampleData *) data_value;
+  guint i;
+
+  /* The timeline lasts one millisecond per sample so that advancing
+     it to each millisecond gives evenly spaced progress values */
+  for (i = 0; i < data->n_samples; i++)
+    {
+      clutter_timeline_advance (data->timeline, i);
+      data->values[i] = clutter_alpha_get_alpha (data->alpha);
+    }
+
+  return Qnil;
+}
+
+static VALUE
+rbclt_alpha_sample_cleanup (VALUE data_value)
+{
+  SampleData *data = (SampleData *) data_value;
+
+  g_object_unref (data->alpha);
+  g_object_unref (data->timeline);
+
+  return Qnil;
+}
+
+/* Calls the proc once for each sample to build a lookup table that
+   can then be evaluated without calling back into Ruby */
+static VALUE
+rbclt_alpha_sample_proc (VALUE proc, VALUE n_samples)
+{
+  SampleData data;
+  RBCLTCurve *curve;
+  VALUE curve_value;
+
+  data.n_samples = NUM2UINT (n_samples);
+
+  if (data.n_samples < 2)
+    rb_raise (rb_eArgError, "at least two samples are needed");
+
+  curve = g_slice_new (RBCLTCurve);
+  curve->type = RBCLT_CURVE_LINEAR;
+  curve->u.linear.n_values = data.n_samples;
+  curve->u.linear.values = data.values = g_new (gdouble, data.n_samples);
+
+  data.timeline = clutter_timeline_new (data.n_samples - 1);
+  data.alpha = g_object_ref_sink (clutter_alpha_new ());
+  clutter_alpha_set_timeline (data.alpha, data.timeline);
+  clutter_alpha_set_closure (data.alpha, rbclt_alpha_proc_to_closure (proc));
+
+  /* The curve is wrapped before calling the proc so that it will
+     still be freed if the proc raises an exception */
+  curve_value = rbclt_curve_to_value (curve);
+
+  rb_ensure (rbclt_alpha_do_sample, (VALUE) &data,
+             rbclt_alpha_sample_cleanup, (VALUE) &data);
+
+  return curve_value;
+}
+
 static VALUE
 rbclt_alpha_initialize (int argc, VALUE *argv, VALUE self)
 {
-  VALUE timeline, mode;
+  VALUE timeline, mode, n_samples;
   ClutterAlpha *alpha;
 
-  rb_scan_args (argc, argv, "02", &timeline, &mode);
+  rb_scan_args (argc, argv, "03", &timeline, &mode, &n_samples);
 
   alpha = clutter_alpha_new ();
   rbclt_initialize_unowned (self, alpha);
@@ -62,12 +142,22 @@ rbclt_alpha_initialize (int argc, VALUE *argv, VALUE self)
   if (timeline != Qnil)
     clutter_alpha_set_timeline (alpha, RVAL2GOBJ (timeline));
 
+  if (NIL_P (mode) && rb_block_given_p ())
+    mode = rb_block_proc ();
+
+  /* With a number of samples the proc is only called up front to
+     build a lookup table */
+  if (!NIL_P (mode) && !NIL_P (n_samples) && !rbclt_is_kind_of_curve (mode))
+    mode = rbclt_alpha_sample_proc (mode, n_samples);
+
   if (NIL_P (mode))
-    {
-      if (rb_block_given_p ())
-        clutter_alpha_set_closure (alpha,
-                                   rbclt_alpha_proc_to_closure (Qnil));
-    }
+    return Qnil;
+
+  /* Curves are evaluated natively without calling back into Ruby */
+  if (rbclt_is_kind_of_curve (mode))
+    clutter_alpha_set_func (alpha, rbclt_curve_alpha_func,
+                            rbclt_curve_copy (rbclt_curve_get_pointer (mode)),
+                            (GDestroyNotify) rbclt_curve_free);
   /* If the mode quacks like a Proc then we'll treat it as one */
   else if (rb_respond_to (mode, id_call))
     clutter_alpha_set_closure (alpha, rbclt_alpha_proc_to_closure (mode));
@@ -81,19 +171,55 @@ rbclt_alpha_initialize (int argc, VALUE *argv, VALUE self)
 static VALUE
 rbclt_alpha_register_func (int argc, VALUE *argv, VALUE self)
 {
-  VALUE proc;
+  VALUE proc, n_samples;
   GClosure *closure;
   gulong id;
 
-  rb_scan_args (argc, argv, "01", &proc);
+  rb_scan_args (argc, argv, "02", &proc, &n_samples);
+
+  if (!NIL_P (n_samples) && !rbclt_is_kind_of_curve (proc))
+    {
+      if (NIL_P (proc))
+        {
+          rb_need_block ();
+          proc = rb_block_proc ();
+        }
 
-  closure = rbclt_alpha_proc_to_closure (proc);
+      proc = rbclt_alpha_sample_proc (proc, n_samples);
+    }
+
+  if (rbclt_is_kind_of_curve (proc))
+    /* Registered functions are never unregistered so the copy of the
+       curve is never freed */
+    id = clutter_alpha_register_func (rbclt_curve_alpha_func,
+                                      rbclt_curve_copy
+                                      (rbclt_curve_get_pointer (proc)));
+  else
+    {
+      closure = rbclt_alpha_proc_to_closure (proc);
 
-  id = clutter_alpha_register_closure (closure);
+      id = clutter_alpha_register_closure (closure);
+    }
 
   return ULONG2NUM (id);
 }
 
+static VALUE
+rbclt_alpha_sample (int argc, VALUE *argv, VALUE self)
+{
+  VALUE n_samples, proc;
+
+  rb_scan_args (argc, argv, "11", &n_samples, &proc);
+
+  if (NIL_P (proc))
+    {
+      rb_need_block ();
+      proc = rb_block_proc ();
+    }
+
+  return rbclt_alpha_sample_proc (proc, n_samples);
+}
+
 void
 rbclt_alpha_init ()
 {
@@ -107,6 +233,7 @@ rbclt_alpha_init ()
                               rbclt_alpha_register_func, -1);
   rb_define_singleton_method (klass, "register_closure",
                               rbclt_alpha_register_func, -1);
+  rb_define_singleton_method (klass, "sample", rbclt_alpha_sample, -1);
 
   G_DEF_CLASS (CLUTTER_TYPE_ANIMATION_MODE, "AnimationMode", rbclt_c_clutter);
   G_DEF_CONSTANTS (rbclt_c_clutter, CLUTTER_TYPE_ANIMATION_MODE, "CLUTTER_");
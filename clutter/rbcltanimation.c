@@ -23,6 +23,7 @@
 
 #include "rbclutter.h"
 #include "rbcltactor.h"
+#include "rbcltcurve.h"
 
 static VALUE
 rbclt_animation_intialize (VALUE self)
@@ -274,6 +275,350 @@ rbclt_animation_animate_with_alpha (VALUE self, VALUE alpha, VALUE hash)
   return rbclt_animation_animate_with_data (&data);
 }
 
+/* Animates a set of actors from a single timeline and alpha. Each
+   actor can be delayed by an offset from the start of the timeline so
+   the timeline lasts for the duration plus the longest delay. The
+   easing for each actor is calculated by advancing a private timeline
+   attached to the alpha to the actor's own position within the
+   duration */
+
+typedef struct _AnimateManyData AnimateManyData;
+
+struct _AnimateManyData
+{
+  VALUE actors;
+  VALUE hash;
+  VALUE mode;
+  VALUE stagger;
+  guint duration;
+
+  ClutterTimeline *timeline;
+  /* Whether the reference that keeps the timeline alive while it is
+     playing is held */
+  gboolean holds_timeline;
+  ClutterTimeline *alpha_timeline;
+  ClutterAlpha *alpha;
+
+  guint n_actors;
+  ClutterActor **actor_array;
+  guint *delays;
+  /* The last position within the duration that was applied to each
+     actor so that actors that are waiting or finished are skipped */
+  guint *positions;
+
+  GArray *name_array;
+  GArray *interval_array;
+  /* Initial values for each actor with one row per actor */
+  GValue *initial_values;
+  /* Scratch values used to compute the values for each property */
+  GValue *values;
+};
+
+static void
+rbclt_animation_free_animate_many_data (AnimateManyData *data)
+{
+  guint i, n_properties = data->name_array->len;
+
+  for (i = 0; i < data->n_actors; i++)
+    if (data->actor_array[i])
+      g_object_unref (data->actor_array[i]);
+
+  for (i = 0; i < data->interval_array->len; i++)
+    g_object_unref (g_array_index (data->interval_array,
+                                   ClutterInterval *, i));
+
+  if (data->initial_values)
+    {
+      for (i = 0; i < data->n_actors * n_properties; i++)
+        if (G_IS_VALUE (data->initial_values + i))
+          g_value_unset (data->initial_values + i);
+      for (i = 0; i < n_properties; i++)
+        if (G_IS_VALUE (data->values + i))
+          g_value_unset (data->values + i);
+
+      g_free (data->initial_values);
+      g_free (data->values);
+    }
+
+  for (i = 0; i < n_properties; i++)
+    g_free (g_array_index (data->name_array, char *, i));
+
+  g_array_free (data->name_array, TRUE);
+  g_array_free (data->interval_array, TRUE);
+  g_free (data->actor_array);
+  g_free (data->delays);
+  g_free (data->positions);
+
+  if (data->alpha)
+    g_object_unref (data->alpha);
+  if (data->alpha_timeline)
+    g_object_unref (data->alpha_timeline);
+
+  g_slice_free (AnimateManyData, data);
+}
+
+static void
+rbclt_animation_many_closure_notify (gpointer data, GClosure *closure)
+{
+  rbclt_animation_free_animate_many_data (data);
+}
+
+static void
+rbclt_animation_many_new_frame (ClutterTimeline *timeline,
+                                gint msecs,
+                                AnimateManyData *data)
+{
+  guint elapsed = clutter_timeline_get_elapsed_time (timeline);
+  guint n_properties = data->name_array->len;
+  guint i, p, position;
+  gdouble factor;
+
+  for (i = 0; i < data->n_actors; i++)
+    {
+      ClutterActor *actor = data->actor_array[i];
+      const GValue *initial_values
+        = data->initial_values + i * n_properties;
+
+      if (elapsed <= data->delays[i])
+        position = 0;
+      else
+        position = MIN (elapsed - data->delays[i], data->duration);
+
+      if (position == data->positions[i])
+        continue;
+      data->positions[i] = position;
+
+      clutter_timeline_advance (data->alpha_timeline, position);
+      factor = clutter_alpha_get_alpha (data->alpha);
+
+      g_object_freeze_notify (G_OBJECT (actor));
+
+      for (p = 0; p < n_properties; p++)
+        {
+          ClutterInterval *interval
+            = g_array_index (data->interval_array, ClutterInterval *, p);
+
+          clutter_interval_set_initial_value (interval, initial_values + p);
+          if (clutter_interval_compute_value (interval, factor,
+                                              data->values + p))
+            g_object_set_property (G_OBJECT (actor),
+                                   g_array_index (data->name_array,
+                                                  char *, p),
+                                   data->values + p);
+        }
+
+      g_object_thaw_notify (G_OBJECT (actor));
+    }
+}
+
+/* The timeline is kept alive while it is playing so that the
+   animation runs even if the returned timeline is dropped. Once it
+   stops, completes or is paused only the Ruby wrapper owns it so the
+   animation data is freed along with it */
+static void
+rbclt_animation_many_started (ClutterTimeline *timeline,
+                              AnimateManyData *data)
+{
+  if (!data->holds_timeline)
+    {
+      g_object_ref (timeline);
+      data->holds_timeline = TRUE;
+    }
+}
+
+static void
+rbclt_animation_many_release (ClutterTimeline *timeline,
+                              AnimateManyData *data)
+{
+  if (data->holds_timeline)
+    {
+      data->holds_timeline = FALSE;
+      g_object_unref (timeline);
+    }
+}
+
+static void
+rbclt_animation_many_completed (ClutterTimeline *timeline,
+                                AnimateManyData *data)
+{
+  /* A looping timeline carries on playing after completed */
+  if (!clutter_timeline_get_loop (timeline))
+    rbclt_animation_many_release (timeline, data);
+}
+
+static int
+rbclt_animation_many_hash_cb (VALUE key, VALUE value, VALUE arg)
+{
+  AnimateManyData *data = (AnimateManyData *) arg;
+  GParamSpec *pspec;
+  ClutterInterval *interval;
+  char *name;
+  GValue gval = { 0, };
+
+  name = g_strdup (StringValuePtr (key));
+  g_array_append_val (data->name_array, name);
+
+  /* The property type is taken from the first actor. The other actors
+     are checked when their initial values are read */
+  pspec = g_object_class_find_property (G_OBJECT_GET_CLASS
+                                        (data->actor_array[0]), name);
+  if (pspec == NULL)
+    rb_raise (rb_eArgError, "actor has no property named %s", name);
+
+  g_value_init (&gval, G_PARAM_SPEC_VALUE_TYPE (pspec));
+  rbgobj_rvalue_to_gvalue (value, &gval);
+  interval = clutter_interval_new_with_values (G_VALUE_TYPE (&gval),
+                                               &gval, &gval);
+  g_object_ref_sink (interval);
+  g_array_append_val (data->interval_array, interval);
+  g_value_unset (&gval);
+
+  return ST_CONTINUE;
+}
+
+static VALUE
+rbclt_animation_do_animate_many (VALUE arg)
+{
+  AnimateManyData *data = (AnimateManyData *) arg;
+  guint i, p, n_properties, max_delay = 0;
+
+  data->n_actors = RARRAY_LEN (data->actors);
+
+  if (data->n_actors < 1)
+    rb_raise (rb_eArgError, "no actors to animate");
+
+  data->actor_array = g_new0 (ClutterActor *, data->n_actors);
+  data->delays = g_new0 (guint, data->n_actors);
+  data->positions = g_new0 (guint, data->n_actors);
+
+  for (i = 0; i < data->n_actors && i < RARRAY_LEN (data->actors); i++)
+    data->actor_array[i]
+      = g_object_ref (CLUTTER_ACTOR (RVAL2GOBJ (RARRAY_PTR (data->actors)[i])));
+  data->n_actors = i;
+
+  /* The stagger can either be a fixed delay between each actor or an
+     array with a separate delay for each actor */
+  if (TYPE (data->stagger) == T_ARRAY)
+    {
+      for (i = 0; i < data->n_actors && i < RARRAY_LEN (data->stagger); i++)
+        data->delays[i] = NUM2UINT (RARRAY_PTR (data->stagger)[i]);
+    }
+  else if (!NIL_P (data->stagger))
+    {
+      guint stagger = NUM2UINT (data->stagger);
+
+      for (i = 0; i < data->n_actors; i++)
+        data->delays[i] = i * stagger;
+    }
+
+  for (i = 0; i < data->n_actors; i++)
+    if (data->delays[i] > max_delay)
+      max_delay = data->delays[i];
+
+  rb_hash_foreach (data->hash, rbclt_animation_many_hash_cb, (VALUE) data);
+
+  n_properties = data->name_array->len;
+  data->initial_values = g_new0 (GValue, data->n_actors * n_properties);
+  data->values = g_new0 (GValue, n_properties);
+
+  for (p = 0; p < n_properties; p++)
+    {
+      ClutterInterval *interval
+        = g_array_index (data->interval_array, ClutterInterval *, p);
+      const char *name = g_array_index (data->name_array, char *, p);
+      GType type = clutter_interval_get_value_type (interval);
+
+      g_value_init (data->values + p, type);
+
+      for (i = 0; i < data->n_actors; i++)
+        {
+          GValue *value = data->initial_values + i * n_properties + p;
+          GParamSpec *pspec
+            = g_object_class_find_property (G_OBJECT_GET_CLASS
+                                            (data->actor_array[i]), name);
+
+          if (pspec == NULL || G_PARAM_SPEC_VALUE_TYPE (pspec) != type)
+            rb_raise (rb_eArgError, "the property %s does not have the same "
+                      "type in all of the actors", name);
+
+          g_value_init (value, type);
+          g_object_get_property (G_OBJECT (data->actor_array[i]),
+                                 name, value);
+        }
+    }
+
+  data->alpha_timeline = clutter_timeline_new (data->duration);
+  data->alpha = g_object_ref_sink (clutter_alpha_new ());
+  clutter_alpha_set_timeline (data->alpha, data->alpha_timeline);
+
+  if (rbclt_is_kind_of_curve (data->mode))
+    clutter_alpha_set_func (data->alpha, rbclt_curve_alpha_func,
+                            rbclt_curve_copy
+                            (rbclt_curve_get_pointer (data->mode)),
+                            (GDestroyNotify) rbclt_curve_free);
+  else
+    clutter_alpha_set_mode (data->alpha, NUM2ULONG (data->mode));
+
+  /* The timeline takes ownership of the data from here */
+  data->timeline = clutter_timeline_new (data->duration + max_delay);
+  g_signal_connect_data (data->timeline, "new-frame",
+                         G_CALLBACK (rbclt_animation_many_new_frame), data,
+                         rbclt_animation_many_closure_notify, 0);
+  /* The reference from creating the timeline is the one held while
+     it plays */
+  data->holds_timeline = TRUE;
+  g_signal_connect (data->timeline, "started",
+                    G_CALLBACK (rbclt_animation_many_started), data);
+  g_signal_connect (data->timeline, "paused",
+                    G_CALLBACK (rbclt_animation_many_release), data);
+  g_signal_connect (data->timeline, "completed",
+                    G_CALLBACK (rbclt_animation_many_completed), data);
+
+  clutter_timeline_start (data->timeline);
+
+  return GOBJ2RVAL (data->timeline);
+}
+
+static VALUE
+rbclt_animation_free_unused_animate_many_data (VALUE arg)
+{
+  AnimateManyData *data = (AnimateManyData *) arg;
+
+  /* If the timeline was created then it owns the data */
+  if (data->timeline == NULL)
+    rbclt_animation_free_animate_many_data (data);
+
+  return Qnil;
+}
+
+static VALUE
+rbclt_animation_animate_many (int argc, VALUE *argv, VALUE self)
+{
+  VALUE actors, mode, duration, hash, stagger;
+  AnimateManyData *data;
+
+  rb_scan_args (argc, argv, "41", &actors, &mode, &duration, &hash, &stagger);
+
+  /* Allow the stagger to be given as an option hash so that it can be
+     passed like a keyword argument */
+  if (TYPE (stagger) == T_HASH)
+    stagger = rb_hash_aref (stagger, ID2SYM (rb_intern ("stagger")));
+
+  data = g_slice_new0 (AnimateManyData);
+  data->actors = rb_convert_type (actors, T_ARRAY, "Array", "to_ary");
+  data->mode = mode;
+  data->duration = NUM2UINT (duration);
+  data->hash = hash;
+  data->stagger = stagger;
+  data->name_array = g_array_new (FALSE, FALSE, sizeof (char *));
+  data->interval_array = g_array_new (FALSE, FALSE,
+                                      sizeof (ClutterInterval *));
+
+  return rb_ensure (rbclt_animation_do_animate_many, (VALUE) data,
+                    rbclt_animation_free_unused_animate_many_data,
+                    (VALUE) data);
+}
+
 void
 rbclt_animation_init ()
 {
@@ -292,6 +637,9 @@ rbclt_animation_init ()
   rb_define_method (klass, "get_interval", rbclt_animation_get_interval, 1);
   rb_define_method (klass, "completed", rbclt_animation_completed, 0);
 
+  rb_define_singleton_method (klass, "animate_many",
+                              rbclt_animation_animate_many, -1);
+
   /* Actor methods */
   rb_define_method (rbclt_c_actor, "animation",
                     rbclt_animation_get_animation, 0);
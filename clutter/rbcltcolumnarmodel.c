@@ -0,0 +1,1213 @@
+/* Ruby bindings for the Clutter 'interactive canvas' library.
+ * Copyright (C) 2010  Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#include <rbgobject.h>
+#include <clutter/clutter.h>
+#include <string.h>
+
+#include "rbclutter.h"
+#include "rbcltcolumnarmodel.h"
+
+/* ColumnarModel is a ClutterModel that stores each column as a packed
+   array of values instead of a GValue per cell. The iterators just
+   hold a row number into the arrays */
+
+#define RBCLT_TYPE_COLUMNAR_MODEL_ITER (rbclt_columnar_model_iter_get_type ())
+#define RBCLT_COLUMNAR_MODEL_ITER(obj)                                  \
+  (G_TYPE_CHECK_INSTANCE_CAST ((obj), RBCLT_TYPE_COLUMNAR_MODEL_ITER,   \
+                               RBCLTColumnarModelIter))
+
+typedef struct _RBCLTColumnarModelIter RBCLTColumnarModelIter;
+typedef struct _RBCLTColumnarModelIterClass RBCLTColumnarModelIterClass;
+
+struct _RBCLTColumnarModelIter
+{
+  ClutterModelIter parent;
+
+  RBCLTColumnarModel *model;
+  guint row;
+};
+
+struct _RBCLTColumnarModelIterClass
+{
+  ClutterModelIterClass parent_class;
+};
+
+static GType rbclt_columnar_model_iter_get_type (void) G_GNUC_CONST;
+
+G_DEFINE_TYPE (RBCLTColumnarModelIter, rbclt_columnar_model_iter,
+               CLUTTER_TYPE_MODEL_ITER);
+
+/* The GObject functions use a different prefix so that they don't
+   clash with rbclt_columnar_model_init for the Ruby class */
+G_DEFINE_TYPE (RBCLTColumnarModel, rbclt_columnar_model_object,
+               CLUTTER_TYPE_MODEL);
+
+static ClutterModelIter *
+rbclt_columnar_model_iter_new (RBCLTColumnarModel *model, guint row)
+{
+  RBCLTColumnarModelIter *iter;
+
+  iter = g_object_new (RBCLT_TYPE_COLUMNAR_MODEL_ITER,
+                       "model", model,
+                       NULL);
+  iter->model = g_object_ref (model);
+  iter->row = row;
+
+  return CLUTTER_MODEL_ITER (iter);
+}
+
+static void
+rbclt_columnar_model_iter_dispose (GObject *object)
+{
+  RBCLTColumnarModelIter *iter = RBCLT_COLUMNAR_MODEL_ITER (object);
+
+  if (iter->model)
+    {
+      g_object_unref (iter->model);
+      iter->model = NULL;
+    }
+
+  G_OBJECT_CLASS (rbclt_columnar_model_iter_parent_class)->dispose (object);
+}
+
+static void
+rbclt_columnar_model_get_cell (RBCLTColumnarModel *model,
+                               guint column, guint row,
+                               GValue *value)
+{
+  switch (model->kinds[column])
+    {
+    case RBCLT_COLUMN_INT:
+      g_value_set_int (value, RBCLT_COLUMNAR_MODEL_VALUE (model, gint,
+                                                          column, row));
+      break;
+    case RBCLT_COLUMN_UINT:
+      g_value_set_uint (value, RBCLT_COLUMNAR_MODEL_VALUE (model, guint,
+                                                           column, row));
+      break;
+    case RBCLT_COLUMN_BOOLEAN:
+      g_value_set_boolean (value, RBCLT_COLUMNAR_MODEL_VALUE (model, gint,
+                                                              column, row));
+      break;
+    case RBCLT_COLUMN_FLOAT:
+      g_value_set_float (value, RBCLT_COLUMNAR_MODEL_VALUE (model, gfloat,
+                                                            column, row));
+      break;
+    case RBCLT_COLUMN_DOUBLE:
+      g_value_set_double (value, RBCLT_COLUMNAR_MODEL_VALUE (model, gdouble,
+                                                             column, row));
+      break;
+    case RBCLT_COLUMN_STRING:
+      g_value_set_static_string (value,
+                                 RBCLT_COLUMNAR_MODEL_VALUE (model,
+                                                             const gchar *,
+                                                             column, row));
+      break;
+    }
+}
+
+static void
+rbclt_columnar_model_set_cell (RBCLTColumnarModel *model,
+                               guint column, guint row,
+                               const GValue *value)
+{
+  switch (model->kinds[column])
+    {
+    case RBCLT_COLUMN_INT:
+      RBCLT_COLUMNAR_MODEL_VALUE (model, gint, column, row)
+        = g_value_get_int (value);
+      break;
+    case RBCLT_COLUMN_UINT:
+      RBCLT_COLUMNAR_MODEL_VALUE (model, guint, column, row)
+        = g_value_get_uint (value);
+      break;
+    case RBCLT_COLUMN_BOOLEAN:
+      RBCLT_COLUMNAR_MODEL_VALUE (model, gint, column, row)
+        = g_value_get_boolean (value);
+      break;
+    case RBCLT_COLUMN_FLOAT:
+      RBCLT_COLUMNAR_MODEL_VALUE (model, gfloat, column, row)
+        = g_value_get_float (value);
+      break;
+    case RBCLT_COLUMN_DOUBLE:
+      RBCLT_COLUMNAR_MODEL_VALUE (model, gdouble, column, row)
+        = g_value_get_double (value);
+      break;
+    case RBCLT_COLUMN_STRING:
+      RBCLT_COLUMNAR_MODEL_VALUE (model, const gchar *, column, row)
+        = g_intern_string (g_value_get_string (value));
+      break;
+    }
+}
+
+#define RBCLT_COMPARE(a, b) ((a) < (b) ? -1 : (a) > (b) ? 1 : 0)
+
+static gint
+rbclt_columnar_model_compare_keys (RBCLTColumnarModel *model,
+                                   guint row_a, guint row_b)
+{
+  guint i;
+
+  for (i = 0; i < model->n_sort_keys; i++)
+    {
+      guint column = model->sort_keys[i].column;
+      gint ret = 0;
+
+      switch (model->kinds[column])
+        {
+        case RBCLT_COLUMN_INT:
+        case RBCLT_COLUMN_BOOLEAN:
+          ret = RBCLT_COMPARE (RBCLT_COLUMNAR_MODEL_VALUE (model, gint,
+                                                          column, row_a),
+                               RBCLT_COLUMNAR_MODEL_VALUE (model, gint,
+                                                          column, row_b));
+          break;
+        case RBCLT_COLUMN_UINT:
+          ret = RBCLT_COMPARE (RBCLT_COLUMNAR_MODEL_VALUE (model, guint,
+                                                          column, row_a),
+                               RBCLT_COLUMNAR_MODEL_VALUE (model, guint,
+                                                          column, row_b));
+          break;
+        case RBCLT_COLUMN_FLOAT:
+          ret = RBCLT_COMPARE (RBCLT_COLUMNAR_MODEL_VALUE (model, gfloat,
+                                                          column, row_a),
+                               RBCLT_COLUMNAR_MODEL_VALUE (model, gfloat,
+                                                          column, row_b));
+          break;
+        case RBCLT_COLUMN_DOUBLE:
+          ret = RBCLT_COMPARE (RBCLT_COLUMNAR_MODEL_VALUE (model, gdouble,
+                                                          column, row_a),
+                               RBCLT_COLUMNAR_MODEL_VALUE (model, gdouble,
+                                                          column, row_b));
+          break;
+        case RBCLT_COLUMN_STRING:
+          ret = g_strcmp0 (RBCLT_COLUMNAR_MODEL_VALUE (model, const gchar *,
+                                                      column, row_a),
+                           RBCLT_COLUMNAR_MODEL_VALUE (model, const gchar *,
+                                                      column, row_b));
+          break;
+        }
+
+      if (ret)
+        return model->sort_keys[i].descending ? -ret : ret;
+    }
+
+  return 0;
+}
+
+static void
+rbclt_columnar_model_move_row (RBCLTColumnarModel *model,
+                               guint from, guint to)
+{
+  guint8 tmp[sizeof (gdouble)];
+  guint i;
+
+  for (i = 0; i < model->n_columns; i++)
+    {
+      guint size = g_array_get_element_size (model->columns[i]);
+      guint8 *data = (guint8 *) model->columns[i]->data;
+
+      memcpy (tmp, data + from * size, size);
+      if (from < to)
+        memmove (data + from * size, data + (from + 1) * size,
+                 (to - from) * size);
+      else
+        memmove (data + (to + 1) * size, data + to * size,
+                 (from - to) * size);
+      memcpy (data + to * size, tmp, size);
+    }
+}
+
+/* Moves a row whose sort key has changed to its sorted position among
+   the other rows, which must already be in order. Equal rows stay in
+   insertion order. Returns the new position */
+static guint
+rbclt_columnar_model_reposition_row (RBCLTColumnarModel *model, guint row)
+{
+  guint lo, hi, mid;
+
+  if (model->n_sort_keys == 0)
+    return row;
+
+  if (row > 0 && rbclt_columnar_model_compare_keys (model, row, row - 1) < 0)
+    {
+      /* Find the first earlier row that sorts after this one */
+      lo = 0;
+      hi = row - 1;
+      while (lo < hi)
+        {
+          mid = (lo + hi) / 2;
+          if (rbclt_columnar_model_compare_keys (model, row, mid) < 0)
+            hi = mid;
+          else
+            lo = mid + 1;
+        }
+    }
+  else if (row + 1 < model->n_rows
+           && rbclt_columnar_model_compare_keys (model, row, row + 1) > 0)
+    {
+      /* Find the last later row that doesn't sort after this one */
+      lo = row + 1;
+      hi = model->n_rows - 1;
+      while (lo < hi)
+        {
+          mid = (lo + hi + 1) / 2;
+          if (rbclt_columnar_model_compare_keys (model, row, mid) >= 0)
+            lo = mid;
+          else
+            hi = mid - 1;
+        }
+    }
+  else
+    return row;
+
+  rbclt_columnar_model_move_row (model, row, lo);
+
+  return lo;
+}
+
+static gboolean
+rbclt_columnar_model_is_sort_key (RBCLTColumnarModel *model, guint column)
+{
+  guint i;
+
+  for (i = 0; i < model->n_sort_keys; i++)
+    if (model->sort_keys[i].column == column)
+      return TRUE;
+
+  return FALSE;
+}
+
+static void
+rbclt_columnar_model_iter_get_value (ClutterModelIter *iter_base,
+                                     guint column,
+                                     GValue *value)
+{
+  RBCLTColumnarModelIter *iter = RBCLT_COLUMNAR_MODEL_ITER (iter_base);
+
+  g_return_if_fail (column < iter->model->n_columns);
+  g_return_if_fail (iter->row < iter->model->n_rows);
+
+  rbclt_columnar_model_get_cell (iter->model, column, iter->row, value);
+}
+
+static void
+rbclt_columnar_model_iter_set_value (ClutterModelIter *iter_base,
+                                     guint column,
+                                     const GValue *value)
+{
+  RBCLTColumnarModelIter *iter = RBCLT_COLUMNAR_MODEL_ITER (iter_base);
+  GType column_type;
+
+  g_return_if_fail (column < iter->model->n_columns);
+  g_return_if_fail (iter->row < iter->model->n_rows);
+
+  column_type = clutter_model_get_column_type (CLUTTER_MODEL (iter->model),
+                                               column);
+
+  if (G_VALUE_TYPE (value) == column_type)
+    rbclt_columnar_model_set_cell (iter->model, column, iter->row, value);
+  else
+    {
+      GValue real_value = { 0, };
+
+      g_value_init (&real_value, column_type);
+
+      if (g_value_transform (value, &real_value))
+        rbclt_columnar_model_set_cell (iter->model, column, iter->row,
+                                       &real_value);
+      else
+        g_warning ("Unable to convert from %s to %s",
+                   g_type_name (G_VALUE_TYPE (value)),
+                   g_type_name (column_type));
+
+      g_value_unset (&real_value);
+    }
+
+  /* Keep the rows in order if a sort key changed. The iterator
+     follows the row to its new position */
+  if (rbclt_columnar_model_is_sort_key (iter->model, column))
+    {
+      guint old_row = iter->row;
+
+      iter->row = rbclt_columnar_model_reposition_row (iter->model, old_row);
+
+      /* Views need to know that the rows in between have moved */
+      if (iter->row != old_row)
+        g_signal_emit_by_name (iter->model, "sort-changed");
+    }
+}
+
+/* Finds the next row starting from the given row that isn't hidden by
+   the filter. Returns n_rows if there isn't one */
+static guint
+rbclt_columnar_model_next_visible_row (RBCLTColumnarModel *model,
+                                       RBCLTColumnarModelIter *iter,
+                                       guint row)
+{
+  ClutterModel *model_base = CLUTTER_MODEL (model);
+  guint old_row = iter->row;
+
+  if (!clutter_model_get_filter_set (model_base))
+    return row;
+
+  for (; row < model->n_rows; row++)
+    {
+      iter->row = row;
+      if (clutter_model_filter_iter (model_base, CLUTTER_MODEL_ITER (iter)))
+        break;
+    }
+
+  iter->row = old_row;
+
+  return row;
+}
+
+/* Same as above but searching backwards. Returns G_MAXUINT if there
+   isn't one */
+static guint
+rbclt_columnar_model_prev_visible_row (RBCLTColumnarModel *model,
+                                       RBCLTColumnarModelIter *iter,
+                                       guint row)
+{
+  ClutterModel *model_base = CLUTTER_MODEL (model);
+  guint old_row = iter->row;
+
+  if (!clutter_model_get_filter_set (model_base))
+    return row;
+
+  for (; row != G_MAXUINT; row--)
+    {
+      iter->row = row;
+      if (clutter_model_filter_iter (model_base, CLUTTER_MODEL_ITER (iter)))
+        break;
+    }
+
+  iter->row = old_row;
+
+  return row;
+}
+
+static gboolean
+rbclt_columnar_model_iter_is_first (ClutterModelIter *iter_base)
+{
+  RBCLTColumnarModelIter *iter = RBCLT_COLUMNAR_MODEL_ITER (iter_base);
+
+  return (iter->row == 0
+          || rbclt_columnar_model_prev_visible_row (iter->model, iter,
+                                                    iter->row - 1)
+          == G_MAXUINT);
+}
+
+static gboolean
+rbclt_columnar_model_iter_is_last (ClutterModelIter *iter_base)
+{
+  RBCLTColumnarModelIter *iter = RBCLT_COLUMNAR_MODEL_ITER (iter_base);
+
+  /* Like the list model this is TRUE once the iterator has moved past
+     the last visible row */
+  return (rbclt_columnar_model_next_visible_row (iter->model, iter, iter->row)
+          >= iter->model->n_rows);
+}
+
+static ClutterModelIter *
+rbclt_columnar_model_iter_next (ClutterModelIter *iter_base)
+{
+  RBCLTColumnarModelIter *iter = RBCLT_COLUMNAR_MODEL_ITER (iter_base);
+
+  if (iter->row < iter->model->n_rows)
+    iter->row = rbclt_columnar_model_next_visible_row (iter->model, iter,
+                                                       iter->row + 1);
+
+  return iter_base;
+}
+
+static ClutterModelIter *
+rbclt_columnar_model_iter_prev (ClutterModelIter *iter_base)
+{
+  RBCLTColumnarModelIter *iter = RBCLT_COLUMNAR_MODEL_ITER (iter_base);
+  guint row;
+
+  if (iter->row > 0
+      && (row = rbclt_columnar_model_prev_visible_row (iter->model, iter,
+                                                       iter->row - 1))
+      != G_MAXUINT)
+    iter->row = row;
+
+  return iter_base;
+}
+
+static ClutterModel *
+rbclt_columnar_model_iter_get_model (ClutterModelIter *iter_base)
+{
+  return CLUTTER_MODEL (RBCLT_COLUMNAR_MODEL_ITER (iter_base)->model);
+}
+
+static guint
+rbclt_columnar_model_iter_get_row (ClutterModelIter *iter_base)
+{
+  return RBCLT_COLUMNAR_MODEL_ITER (iter_base)->row;
+}
+
+static ClutterModelIter *
+rbclt_columnar_model_iter_copy (ClutterModelIter *iter_base)
+{
+  RBCLTColumnarModelIter *iter = RBCLT_COLUMNAR_MODEL_ITER (iter_base);
+
+  return rbclt_columnar_model_iter_new (iter->model, iter->row);
+}
+
+static void
+rbclt_columnar_model_iter_class_init (RBCLTColumnarModelIterClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  ClutterModelIterClass *iter_class = CLUTTER_MODEL_ITER_CLASS (klass);
+
+  gobject_class->dispose = rbclt_columnar_model_iter_dispose;
+
+  iter_class->get_value = rbclt_columnar_model_iter_get_value;
+  iter_class->set_value = rbclt_columnar_model_iter_set_value;
+  iter_class->is_first = rbclt_columnar_model_iter_is_first;
+  iter_class->is_last = rbclt_columnar_model_iter_is_last;
+  iter_class->next = rbclt_columnar_model_iter_next;
+  iter_class->prev = rbclt_columnar_model_iter_prev;
+  iter_class->get_model = rbclt_columnar_model_iter_get_model;
+  iter_class->get_row = rbclt_columnar_model_iter_get_row;
+  iter_class->copy = rbclt_columnar_model_iter_copy;
+}
+
+static void
+rbclt_columnar_model_iter_init (RBCLTColumnarModelIter *iter)
+{
+}
+
+static guint
+rbclt_columnar_model_get_n_rows (ClutterModel *model_base)
+{
+  RBCLTColumnarModel *model = RBCLT_COLUMNAR_MODEL (model_base);
+  RBCLTColumnarModelIter *iter;
+  guint row, count = 0;
+
+  if (!clutter_model_get_filter_set (model_base))
+    return model->n_rows;
+
+  /* Only the rows that pass the filter are counted */
+  iter = (RBCLTColumnarModelIter *) rbclt_columnar_model_iter_new (model, 0);
+  for (row = 0; row < model->n_rows; row++)
+    {
+      iter->row = row;
+      if (clutter_model_filter_iter (model_base, CLUTTER_MODEL_ITER (iter)))
+        count++;
+    }
+  g_object_unref (iter);
+
+  return count;
+}
+
+static ClutterModelIter *
+rbclt_columnar_model_get_iter_at_row (ClutterModel *model_base, guint row)
+{
+  RBCLTColumnarModel *model = RBCLT_COLUMNAR_MODEL (model_base);
+  ClutterModelIter *iter;
+  guint raw_row, count = 0;
+
+  if (!clutter_model_get_filter_set (model_base))
+    return row < model->n_rows
+      ? rbclt_columnar_model_iter_new (model, row) : NULL;
+
+  /* With a filter the row number only counts the visible rows */
+  iter = rbclt_columnar_model_iter_new (model, 0);
+  for (raw_row = 0; raw_row < model->n_rows; raw_row++)
+    {
+      RBCLT_COLUMNAR_MODEL_ITER (iter)->row = raw_row;
+      if (clutter_model_filter_iter (model_base, iter) && count++ == row)
+        return iter;
+    }
+  g_object_unref (iter);
+
+  return NULL;
+}
+
+static ClutterModelIter *
+rbclt_columnar_model_insert_row (ClutterModel *model_base, gint index_)
+{
+  RBCLTColumnarModel *model = RBCLT_COLUMNAR_MODEL (model_base);
+  static const guint8 zero[sizeof (gdouble)] = { 0, };
+  guint i, row;
+
+  if (index_ < 0 || index_ > model->n_rows)
+    index_ = model->n_rows;
+
+  for (i = 0; i < model->n_columns; i++)
+    g_array_insert_vals (model->columns[i], index_, zero, 1);
+
+  model->n_rows++;
+
+  /* The new row sorts as zeroes until its values are set */
+  row = rbclt_columnar_model_reposition_row (model, index_);
+
+  if (row != (guint) index_)
+    g_signal_emit_by_name (model, "sort-changed");
+
+  return rbclt_columnar_model_iter_new (model, row);
+}
+
+static void
+rbclt_columnar_model_remove_row (ClutterModel *model_base, guint row)
+{
+  RBCLTColumnarModel *model = RBCLT_COLUMNAR_MODEL (model_base);
+  ClutterModelIter *iter;
+  guint i;
+
+  if (row >= model->n_rows)
+    return;
+
+  iter = rbclt_columnar_model_iter_new (model, row);
+  g_signal_emit_by_name (model, "row-removed", iter);
+  g_object_unref (iter);
+
+  for (i = 0; i < model->n_columns; i++)
+    g_array_remove_index (model->columns[i], row);
+
+  model->n_rows--;
+}
+
+typedef struct _SortData SortData;
+
+struct _SortData
+{
+  RBCLTColumnarModel *model;
+  guint column;
+  ClutterModelSortFunc func;
+  gpointer data;
+  GValue a, b;
+};
+
+static gint
+rbclt_columnar_model_compare_rows (gconstpointer a, gconstpointer b,
+                                   gpointer user_data)
+{
+  SortData *data = user_data;
+  guint row_a = *(const guint *) a, row_b = *(const guint *) b;
+  gint ret;
+
+  rbclt_columnar_model_get_cell (data->model, data->column, row_a, &data->a);
+  rbclt_columnar_model_get_cell (data->model, data->column, row_b, &data->b);
+
+  ret = data->func (CLUTTER_MODEL (data->model), &data->a, &data->b,
+                    data->data);
+
+  /* Keep the sort stable */
+  if (ret == 0)
+    ret = row_a < row_b ? -1 : row_a > row_b ? 1 : 0;
+
+  return ret;
+}
+
+void
+rbclt_columnar_model_reorder (RBCLTColumnarModel *model, const guint *order)
+{
+  guint i, row;
+
+  /* Rebuild each column in the new order */
+  for (i = 0; i < model->n_columns; i++)
+    {
+      GArray *old_column = model->columns[i];
+      guint size = g_array_get_element_size (old_column);
+      GArray *new_column = g_array_sized_new (FALSE, TRUE, size,
+                                              model->n_rows);
+
+      g_array_set_size (new_column, model->n_rows);
+      for (row = 0; row < model->n_rows; row++)
+        memcpy (new_column->data + row * size,
+                old_column->data + order[row] * size, size);
+
+      g_array_free (old_column, TRUE);
+      model->columns[i] = new_column;
+    }
+}
+
+static gint
+rbclt_columnar_model_compare_rows_by_keys (gconstpointer a, gconstpointer b,
+                                           gpointer user_data)
+{
+  guint row_a = *(const guint *) a, row_b = *(const guint *) b;
+  gint ret = rbclt_columnar_model_compare_keys (user_data, row_a, row_b);
+
+  return ret ? ret : RBCLT_COMPARE (row_a, row_b);
+}
+
+static void
+rbclt_columnar_model_sort_by_keys (RBCLTColumnarModel *model)
+{
+  guint *order = g_new (guint, model->n_rows), row;
+
+  for (row = 0; row < model->n_rows; row++)
+    order[row] = row;
+
+  g_qsort_with_data (order, model->n_rows, sizeof (guint),
+                     rbclt_columnar_model_compare_rows_by_keys, model);
+
+  rbclt_columnar_model_reorder (model, order);
+
+  g_free (order);
+}
+
+/* Sorts the rows after old_n_rows and merges them into the sorted
+   rows before them. Returns the order that was applied so that the
+   caller can find where the new rows ended up */
+static guint *
+rbclt_columnar_model_merge_new_rows (RBCLTColumnarModel *model,
+                                     guint old_n_rows)
+{
+  guint n_new_rows = model->n_rows - old_n_rows;
+  guint *new_rows = g_new (guint, n_new_rows);
+  guint *order = g_new (guint, model->n_rows);
+  guint i, o = 0, n = 0;
+
+  for (i = 0; i < n_new_rows; i++)
+    new_rows[i] = old_n_rows + i;
+
+  g_qsort_with_data (new_rows, n_new_rows, sizeof (guint),
+                     rbclt_columnar_model_compare_rows_by_keys, model);
+
+  for (i = 0; i < model->n_rows; i++)
+    {
+      if (n < n_new_rows
+          && (o >= old_n_rows
+              || rbclt_columnar_model_compare_keys (model, new_rows[n], o) < 0))
+        order[i] = new_rows[n++];
+      else
+        order[i] = o++;
+    }
+
+  rbclt_columnar_model_reorder (model, order);
+
+  g_free (new_rows);
+
+  return order;
+}
+
+static void
+rbclt_columnar_model_resort (ClutterModel *model_base,
+                             ClutterModelSortFunc func,
+                             gpointer data)
+{
+  RBCLTColumnarModel *model = RBCLT_COLUMNAR_MODEL (model_base);
+  gint column = clutter_model_get_sorting_column (model_base);
+  GType column_type;
+  SortData sort_data;
+  guint *order, row;
+
+  /* The sort keys take priority over a sort function */
+  if (model->n_sort_keys > 0)
+    {
+      rbclt_columnar_model_sort_by_keys (model);
+      return;
+    }
+
+  if (func == NULL || column < 0 || column >= model->n_columns)
+    return;
+
+  column_type = clutter_model_get_column_type (model_base, column);
+
+  sort_data.model = model;
+  sort_data.column = column;
+  sort_data.func = func;
+  sort_data.data = data;
+  memset (&sort_data.a, 0, sizeof (GValue));
+  memset (&sort_data.b, 0, sizeof (GValue));
+  g_value_init (&sort_data.a, column_type);
+  g_value_init (&sort_data.b, column_type);
+
+  order = g_new (guint, model->n_rows);
+  for (row = 0; row < model->n_rows; row++)
+    order[row] = row;
+
+  g_qsort_with_data (order, model->n_rows, sizeof (guint),
+                     rbclt_columnar_model_compare_rows, &sort_data);
+
+  rbclt_columnar_model_reorder (model, order);
+
+  g_free (order);
+  g_value_unset (&sort_data.a);
+  g_value_unset (&sort_data.b);
+}
+
+static void
+rbclt_columnar_model_finalize (GObject *object)
+{
+  RBCLTColumnarModel *model = RBCLT_COLUMNAR_MODEL (object);
+  guint i;
+
+  for (i = 0; i < model->n_columns; i++)
+    g_array_free (model->columns[i], TRUE);
+  g_free (model->columns);
+  g_free (model->kinds);
+  g_free (model->sort_keys);
+
+  G_OBJECT_CLASS (rbclt_columnar_model_object_parent_class)->finalize (object);
+}
+
+static void
+rbclt_columnar_model_object_class_init (RBCLTColumnarModelClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  ClutterModelClass *model_class = CLUTTER_MODEL_CLASS (klass);
+
+  gobject_class->finalize = rbclt_columnar_model_finalize;
+
+  model_class->get_n_rows = rbclt_columnar_model_get_n_rows;
+  model_class->get_iter_at_row = rbclt_columnar_model_get_iter_at_row;
+  model_class->insert_row = rbclt_columnar_model_insert_row;
+  model_class->remove_row = rbclt_columnar_model_remove_row;
+  model_class->resort = rbclt_columnar_model_resort;
+}
+
+static void
+rbclt_columnar_model_object_init (RBCLTColumnarModel *model)
+{
+}
+
+static gboolean
+rbclt_columnar_model_kind_for_type (GType type, RBCLTColumnKind *kind)
+{
+  switch (type)
+    {
+    case G_TYPE_INT: *kind = RBCLT_COLUMN_INT; return TRUE;
+    case G_TYPE_UINT: *kind = RBCLT_COLUMN_UINT; return TRUE;
+    case G_TYPE_BOOLEAN: *kind = RBCLT_COLUMN_BOOLEAN; return TRUE;
+    case G_TYPE_FLOAT: *kind = RBCLT_COLUMN_FLOAT; return TRUE;
+    case G_TYPE_DOUBLE: *kind = RBCLT_COLUMN_DOUBLE; return TRUE;
+    case G_TYPE_STRING: *kind = RBCLT_COLUMN_STRING; return TRUE;
+    }
+
+  return FALSE;
+}
+
+static guint
+rbclt_columnar_model_kind_size (RBCLTColumnKind kind)
+{
+  switch (kind)
+    {
+    case RBCLT_COLUMN_INT:
+    case RBCLT_COLUMN_UINT:
+    case RBCLT_COLUMN_BOOLEAN:
+      return sizeof (gint);
+    case RBCLT_COLUMN_FLOAT:
+      return sizeof (gfloat);
+    case RBCLT_COLUMN_DOUBLE:
+      return sizeof (gdouble);
+    case RBCLT_COLUMN_STRING:
+      return sizeof (const gchar *);
+    }
+
+  return 0;
+}
+
+typedef struct _InitializeData InitializeData;
+
+struct _InitializeData
+{
+  int argc;
+  VALUE *argv;
+  VALUE self;
+  GType *types;
+  const gchar **names;
+};
+
+static VALUE
+rbclt_columnar_model_do_initialize (VALUE arg)
+{
+  InitializeData *data = (InitializeData *) arg;
+  RBCLTColumnarModel *model;
+  RBCLTColumnKind kind;
+  int i, n_columns = data->argc / 2;
+
+  for (i = 0; i < n_columns; i++)
+    {
+      data->types[i] = rbgobj_gtype_get (data->argv[i * 2]);
+      data->names[i] = StringValuePtr (data->argv[i * 2 + 1]);
+
+      if (!rbclt_columnar_model_kind_for_type (data->types[i], &kind))
+        rb_raise (rb_eArgError, "unsupported column type %s",
+                  g_type_name (data->types[i]));
+    }
+
+  model = g_object_new (RBCLT_TYPE_COLUMNAR_MODEL, NULL);
+  clutter_model_set_types (CLUTTER_MODEL (model), n_columns, data->types);
+  clutter_model_set_names (CLUTTER_MODEL (model), n_columns, data->names);
+
+  model->n_columns = n_columns;
+  model->kinds = g_new (RBCLTColumnKind, n_columns);
+  model->columns = g_new (GArray *, n_columns);
+
+  for (i = 0; i < n_columns; i++)
+    {
+      rbclt_columnar_model_kind_for_type (data->types[i], model->kinds + i);
+      model->columns[i]
+        = g_array_new (FALSE, TRUE,
+                       rbclt_columnar_model_kind_size (model->kinds[i]));
+    }
+
+  G_INITIALIZE (data->self, model);
+
+  return Qnil;
+}
+
+static VALUE
+rbclt_columnar_model_free_init_data (VALUE arg)
+{
+  InitializeData *data = (InitializeData *) arg;
+
+  free (data->types);
+  free (data->names);
+
+  return Qnil;
+}
+
+static VALUE
+rbclt_columnar_model_initialize (int argc, VALUE *argv, VALUE self)
+{
+  InitializeData data;
+
+  if (argc < 1)
+    rb_raise (rb_eArgError, "wrong number of arguments "
+              "(at least two required)");
+  else if ((argc & 1))
+    rb_raise (rb_eArgError, "wrong number of arguments "
+              "(paired arguments required)");
+
+  data.argc = argc;
+  data.argv = argv;
+  data.self = self;
+  data.types = ALLOC_N (GType, argc / 2);
+  data.names = ALLOC_N (const gchar *, argc / 2);
+
+  return rb_ensure (rbclt_columnar_model_do_initialize, (VALUE) &data,
+                    rbclt_columnar_model_free_init_data, (VALUE) &data);
+}
+
+guint
+rbclt_columnar_model_lookup_column (RBCLTColumnarModel *model, VALUE column)
+{
+  guint i;
+
+  if (FIXNUM_P (column))
+    {
+      i = NUM2UINT (column);
+
+      if (i >= model->n_columns)
+        rb_raise (rb_eArgError, "column %u out of range", i);
+
+      return i;
+    }
+  else
+    {
+      const gchar *name = SYMBOL_P (column)
+        ? rb_id2name (SYM2ID (column)) : StringValuePtr (column);
+
+      for (i = 0; i < model->n_columns; i++)
+        if (!strcmp (clutter_model_get_column_name (CLUTTER_MODEL (model), i),
+                     name))
+          return i;
+
+      rb_raise (rb_eArgError, "no column named %s", name);
+    }
+
+  return 0;
+}
+
+typedef struct _AppendRowsData AppendRowsData;
+
+struct _AppendRowsData
+{
+  RBCLTColumnarModel *model;
+  VALUE hash;
+  guint old_n_rows;
+  guint n_new_rows;
+  gboolean done;
+};
+
+static int
+rbclt_columnar_model_count_rows_cb (VALUE key, VALUE value, VALUE arg)
+{
+  AppendRowsData *data = (AppendRowsData *) arg;
+  guint column = rbclt_columnar_model_lookup_column (data->model, key);
+  long n_rows;
+
+  if (TYPE (value) == T_ARRAY)
+    n_rows = RARRAY_LEN (value);
+  else
+    {
+      guint size = g_array_get_element_size (data->model->columns[column]);
+
+      if (data->model->kinds[column] == RBCLT_COLUMN_STRING)
+        rb_raise (rb_eArgError, "string columns must be given as an Array");
+
+      StringValue (value);
+      if (RSTRING_LEN (value) % size)
+        rb_raise (rb_eArgError, "packed data for column %u is not a multiple "
+                  "of the value size", column);
+
+      n_rows = RSTRING_LEN (value) / size;
+    }
+
+  if (data->n_new_rows == G_MAXUINT)
+    data->n_new_rows = n_rows;
+  else if (data->n_new_rows != n_rows)
+    rb_raise (rb_eArgError, "all columns must have the same number of rows");
+
+  return ST_CONTINUE;
+}
+
+static int
+rbclt_columnar_model_fill_column_cb (VALUE key, VALUE value, VALUE arg)
+{
+  AppendRowsData *data = (AppendRowsData *) arg;
+  RBCLTColumnarModel *model = data->model;
+  guint column = rbclt_columnar_model_lookup_column (model, key);
+  GArray *array = model->columns[column];
+  guint8 *dest = (guint8 *) array->data
+    + data->old_n_rows * g_array_get_element_size (array);
+  guint i;
+
+  if (TYPE (value) != T_ARRAY)
+    {
+      StringValue (value);
+      memcpy (dest, RSTRING_PTR (value),
+              MIN (RSTRING_LEN (value),
+                   data->n_new_rows * g_array_get_element_size (array)));
+      return ST_CONTINUE;
+    }
+
+  /* The length of the array is checked again in case converting one
+     of the values modified it */
+  for (i = 0; i < data->n_new_rows && i < RARRAY_LEN (value); i++)
+    {
+      VALUE v = RARRAY_PTR (value)[i];
+
+      switch (model->kinds[column])
+        {
+        case RBCLT_COLUMN_INT:
+          ((gint *) dest)[i] = NUM2INT (v);
+          break;
+        case RBCLT_COLUMN_UINT:
+          ((guint *) dest)[i] = NUM2UINT (v);
+          break;
+        case RBCLT_COLUMN_BOOLEAN:
+          ((gint *) dest)[i] = RTEST (v);
+          break;
+        case RBCLT_COLUMN_FLOAT:
+          ((gfloat *) dest)[i] = NUM2DBL (v);
+          break;
+        case RBCLT_COLUMN_DOUBLE:
+          ((gdouble *) dest)[i] = NUM2DBL (v);
+          break;
+        case RBCLT_COLUMN_STRING:
+          ((const gchar **) dest)[i]
+            = NIL_P (v) ? NULL : g_intern_string (StringValueCStr (v));
+          break;
+        }
+    }
+
+  return ST_CONTINUE;
+}
+
+static VALUE
+rbclt_columnar_model_do_append_rows (VALUE arg)
+{
+  AppendRowsData *data = (AppendRowsData *) arg;
+  RBCLTColumnarModel *model = data->model;
+  guint i, new_size;
+
+  rb_hash_foreach (data->hash, rbclt_columnar_model_count_rows_cb, arg);
+
+  if (data->n_new_rows == G_MAXUINT || data->n_new_rows == 0)
+    return Qnil;
+
+  /* Columns that aren't given are left as zeroes */
+  new_size = data->old_n_rows + data->n_new_rows;
+  for (i = 0; i < model->n_columns; i++)
+    g_array_set_size (model->columns[i], new_size);
+
+  rb_hash_foreach (data->hash, rbclt_columnar_model_fill_column_cb, arg);
+
+  data->done = TRUE;
+
+  return Qnil;
+}
+
+static VALUE
+rbclt_columnar_model_free_append_rows_data (VALUE arg)
+{
+  AppendRowsData *data = (AppendRowsData *) arg;
+  guint i;
+
+  /* Put the columns back if converting the values failed */
+  if (!data->done)
+    for (i = 0; i < data->model->n_columns; i++)
+      g_array_set_size (data->model->columns[i], data->old_n_rows);
+
+  return Qnil;
+}
+
+static VALUE
+rbclt_columnar_model_append_rows (VALUE self, VALUE hash)
+{
+  RBCLTColumnarModel *model = RBCLT_COLUMNAR_MODEL (RVAL2GOBJ (self));
+  AppendRowsData data;
+  guint *order = NULL;
+  guint row;
+
+  data.model = model;
+  data.hash = rb_convert_type (hash, T_HASH, "Hash", "to_hash");
+  data.old_n_rows = model->n_rows;
+  data.n_new_rows = G_MAXUINT;
+  data.done = FALSE;
+
+  rb_ensure (rbclt_columnar_model_do_append_rows, (VALUE) &data,
+             rbclt_columnar_model_free_append_rows_data, (VALUE) &data);
+
+  if (!data.done)
+    return self;
+
+  model->n_rows += data.n_new_rows;
+
+  /* With sort keys the new rows are merged in to place rather than
+     sorting the whole model */
+  if (model->n_sort_keys > 0)
+    order = rbclt_columnar_model_merge_new_rows (model, data.old_n_rows);
+
+  /* Only create an iterator for the signals if someone is listening */
+  if (g_signal_has_handler_pending (model,
+                                    g_signal_lookup ("row-added",
+                                                     CLUTTER_TYPE_MODEL),
+                                    0, FALSE))
+    {
+      ClutterModelIter *iter
+        = rbclt_columnar_model_iter_new (model, data.old_n_rows);
+
+      for (row = order ? 0 : data.old_n_rows; row < model->n_rows; row++)
+        if (order == NULL || order[row] >= data.old_n_rows)
+          {
+            RBCLT_COLUMNAR_MODEL_ITER (iter)->row = row;
+            g_signal_emit_by_name (model, "row-added", iter);
+          }
+
+      g_object_unref (iter);
+    }
+
+  if (order)
+    g_free (order);
+  else if (clutter_model_get_sorting_column (CLUTTER_MODEL (model)) >= 0)
+    clutter_model_resort (CLUTTER_MODEL (model));
+
+  return self;
+}
+
+static VALUE
+rbclt_columnar_model_set_sort_keys (int argc, VALUE *argv, VALUE self)
+{
+  RBCLTColumnarModel *model = RBCLT_COLUMNAR_MODEL (RVAL2GOBJ (self));
+  RBCLTColumnarSortKey *keys;
+  int i;
+
+  /* Each key is a column or an array of [column, direction] */
+  keys = ALLOCA_N (RBCLTColumnarSortKey, argc);
+  for (i = 0; i < argc; i++)
+    {
+      VALUE key = argv[i], direction = Qnil;
+
+      if (TYPE (key) == T_ARRAY)
+        {
+          if (RARRAY_LEN (key) != 2)
+            rb_raise (rb_eArgError, "sort keys must be a column or "
+                      "[column, direction]");
+          direction = RARRAY_PTR (key)[1];
+          key = RARRAY_PTR (key)[0];
+        }
+
+      keys[i].column = rbclt_columnar_model_lookup_column (model, key);
+
+      if (NIL_P (direction) || direction == ID2SYM (rb_intern ("ascending")))
+        keys[i].descending = FALSE;
+      else if (direction == ID2SYM (rb_intern ("descending")))
+        keys[i].descending = TRUE;
+      else
+        rb_raise (rb_eArgError, "sort direction must be :ascending "
+                  "or :descending");
+    }
+
+  g_free (model->sort_keys);
+  model->n_sort_keys = argc;
+  model->sort_keys = g_memdup (keys, sizeof (RBCLTColumnarSortKey) * argc);
+
+  if (argc > 0)
+    {
+      rbclt_columnar_model_sort_by_keys (model);
+      g_signal_emit_by_name (model, "sort-changed");
+    }
+
+  return self;
+}
+
+static VALUE
+rbclt_columnar_model_get_column_data (int argc, VALUE *argv, VALUE self)
+{
+  RBCLTColumnarModel *model = RBCLT_COLUMNAR_MODEL (RVAL2GOBJ (self));
+  VALUE column_arg, start_arg, count_arg;
+  guint column, start, count, size;
+
+  rb_scan_args (argc, argv, "12", &column_arg, &start_arg, &count_arg);
+
+  column = rbclt_columnar_model_lookup_column (model, column_arg);
+  start = NIL_P (start_arg) ? 0 : NUM2UINT (start_arg);
+  count = NIL_P (count_arg) ? G_MAXUINT : NUM2UINT (count_arg);
+
+  if (model->kinds[column] == RBCLT_COLUMN_STRING)
+    rb_raise (rb_eArgError, "string columns can not be packed");
+
+  /* The rows are in storage order so any filter is ignored */
+  if (start > model->n_rows)
+    start = model->n_rows;
+  if (count > model->n_rows - start)
+    count = model->n_rows - start;
+
+  size = g_array_get_element_size (model->columns[column]);
+
+  return rb_str_new (model->columns[column]->data + start * size,
+                     count * size);
+}
+
+void
+rbclt_columnar_model_init ()
+{
+  VALUE klass = G_DEF_CLASS (RBCLT_TYPE_COLUMNAR_MODEL, "ColumnarModel",
+                             rbclt_c_clutter);
+
+  rb_define_method (klass, "initialize", rbclt_columnar_model_initialize, -1);
+  rb_define_method (klass, "append_rows",
+                    rbclt_columnar_model_append_rows, 1);
+  rb_define_method (klass, "set_sort_keys",
+                    rbclt_columnar_model_set_sort_keys, -1);
+  rb_define_method (klass, "column_data",
+                    rbclt_columnar_model_get_column_data, -1);
+}
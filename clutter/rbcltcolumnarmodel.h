@@ -0,0 +1,91 @@
+/* Ruby bindings for the Clutter 'interactive canvas' library.
+ * Copyright (C) 2010  Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#ifndef _RBCLT_COLUMNAR_MODEL_H
+#define _RBCLT_COLUMNAR_MODEL_H
+
+#include <ruby.h>
+#include <clutter/clutter.h>
+
+#define RBCLT_TYPE_COLUMNAR_MODEL (rbclt_columnar_model_object_get_type ())
+#define RBCLT_COLUMNAR_MODEL(obj)                                       \
+  (G_TYPE_CHECK_INSTANCE_CAST ((obj), RBCLT_TYPE_COLUMNAR_MODEL,        \
+                               RBCLTColumnarModel))
+#define RBCLT_IS_COLUMNAR_MODEL(obj)                                    \
+  (G_TYPE_CHECK_INSTANCE_TYPE ((obj), RBCLT_TYPE_COLUMNAR_MODEL))
+
+typedef struct _RBCLTColumnarModel RBCLTColumnarModel;
+typedef struct _RBCLTColumnarModelClass RBCLTColumnarModelClass;
+
+/* How the values of a column are stored */
+typedef enum
+{
+  RBCLT_COLUMN_INT,
+  RBCLT_COLUMN_UINT,
+  RBCLT_COLUMN_BOOLEAN,
+  RBCLT_COLUMN_FLOAT,
+  RBCLT_COLUMN_DOUBLE,
+  /* Interned strings so that each row only stores a pointer */
+  RBCLT_COLUMN_STRING
+} RBCLTColumnKind;
+
+typedef struct _RBCLTColumnarSortKey RBCLTColumnarSortKey;
+
+struct _RBCLTColumnarSortKey
+{
+  guint column;
+  gboolean descending;
+};
+
+struct _RBCLTColumnarModel
+{
+  ClutterModel parent;
+
+  guint n_rows;
+  guint n_columns;
+  RBCLTColumnKind *kinds;
+  /* A GArray of n_rows values for each column */
+  GArray **columns;
+
+  /* When there are sort keys the rows are always kept in order so
+     that inserting a row doesn't require sorting the whole model */
+  guint n_sort_keys;
+  RBCLTColumnarSortKey *sort_keys;
+};
+
+struct _RBCLTColumnarModelClass
+{
+  ClutterModelClass parent_class;
+};
+
+GType rbclt_columnar_model_object_get_type (void) G_GNUC_CONST;
+
+/* Converts a column number, name or symbol to a column number. Raises
+   an exception if there is no such column */
+guint rbclt_columnar_model_lookup_column (RBCLTColumnarModel *model,
+                                         VALUE column);
+
+/* Moves the rows so that row i contains what was in row order[i] */
+void rbclt_columnar_model_reorder (RBCLTColumnarModel *model,
+                                   const guint *order);
+
+#define RBCLT_COLUMNAR_MODEL_VALUE(model, type, column, row)            \
+  (g_array_index ((model)->columns[(column)], type, (row)))
+
+#endif /* _RBCLT_COLUMNAR_MODEL_H */
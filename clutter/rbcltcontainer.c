@@ -30,34 +30,138 @@ struct _ListChildPropertiesData
   guint n_properties;
 };
 
+typedef struct _ChildrenCheckData ChildrenCheckData;
+
+struct _ChildrenCheckData
+{
+  VALUE snapshot;
+  long index;
+  gboolean matches;
+};
+
+/* A frozen array of the wrappers for the children of a container is
+   kept in an instance variable of the container's wrapper. It is only
+   reused while it still matches the children of the container in
+   order. Checking that doesn't need to look up any wrappers so it is
+   much cheaper than building a new array, and it catches children
+   being reordered by anything, such as Actor#raise_top or setting the
+   depth of an actor in a group. A snapshot that is out of date keeps
+   the old children alive until it is next replaced */
+static ID id_children_snapshot;
+
+/* Set of every actor that currently has a parent. The wrappers for
+   these actors are marked directly from this table so that the mark
+   phase doesn't need to recurse through the containers of the scene
+   graph. The set is kept up to date by an emission hook on the
+   parent-set signal */
+static GHashTable *rbclt_container_parented_actors = NULL;
+static VALUE rbclt_container_registry = Qnil;
 
 static void
-rbclt_container_mark_callback (ClutterActor *actor, gpointer data)
+rbclt_container_registry_mark_callback (gpointer key, gpointer value,
+                                        gpointer data)
 {
-  rbgobj_gc_mark_instance (actor);
+  rbgobj_gc_mark_instance (key);
 }
 
 static void
-rbclt_container_mark (void *p)
+rbclt_container_registry_mark (void *p)
 {
-  clutter_container_foreach (CLUTTER_CONTAINER (p),
-                             rbclt_container_mark_callback, NULL);
+  g_hash_table_foreach (rbclt_container_parented_actors,
+                        rbclt_container_registry_mark_callback, NULL);
 }
 
-static VALUE
-rbclt_container_add (int argc, VALUE *argv, VALUE self)
+static gboolean
+rbclt_container_parent_set_hook (GSignalInvocationHint *ihint,
+                                 guint n_param_values,
+                                 const GValue *param_values,
+                                 gpointer data)
 {
-  ClutterContainer *container = CLUTTER_CONTAINER (RVAL2GOBJ (self));
+  ClutterActor *actor = g_value_get_object (param_values);
+
+  if (clutter_actor_get_parent (actor))
+    g_hash_table_insert (rbclt_container_parented_actors, actor, actor);
+  else
+    g_hash_table_remove (rbclt_container_parented_actors, actor);
+
+  return TRUE;
+}
+
+static void
+rbclt_container_init_registry (void)
+{
+  guint signal_id;
+
+  rbclt_container_parented_actors = g_hash_table_new (NULL, NULL);
+
+  /* Wrap the table in an object that is never freed so that it gets
+     marked on every garbage collection */
+  rbclt_container_registry
+    = Data_Wrap_Struct (rb_cObject, rbclt_container_registry_mark, NULL,
+                        rbclt_container_parented_actors);
+  rb_gc_register_address (&rbclt_container_registry);
+
+  /* The class is never unreferenced so that the signal stays
+     registered */
+  g_type_class_ref (CLUTTER_TYPE_ACTOR);
+  signal_id = g_signal_lookup ("parent-set", CLUTTER_TYPE_ACTOR);
+  g_signal_add_emission_hook (signal_id, 0, rbclt_container_parent_set_hook,
+                              NULL, NULL);
+}
+
+/* Converts the arguments to a list of actors. Arrays of actors are
+   expanded so that large numbers of children can be passed without
+   splatting them. All of the arguments are checked before the
+   container is changed so that an error doesn't leave it half
+   updated */
+static GPtrArray *
+rbclt_container_collect_actors (int argc, VALUE *argv)
+{
+  GPtrArray *actors = g_ptr_array_sized_new (argc);
   int i;
+  long j;
 
   for (i = 0; i < argc; i++)
     {
-      gpointer actor = RVAL2GOBJ (argv[i]);
-      if (!CLUTTER_IS_ACTOR (actor))
-        rb_raise (rb_eArgError, "Actor required");
-      clutter_container_add_actor (container, CLUTTER_ACTOR (actor));
+      if (TYPE (argv[i]) == T_ARRAY)
+        for (j = 0; j < RARRAY_LEN (argv[i]); j++)
+          g_ptr_array_add (actors, (gpointer) RARRAY_PTR (argv[i])[j]);
+      else
+        g_ptr_array_add (actors, (gpointer) argv[i]);
+    }
+
+  for (i = 0; i < actors->len; i++)
+    {
+      gpointer actor;
+
+      if (!RTEST (rb_obj_is_kind_of ((VALUE) g_ptr_array_index (actors, i),
+                                     GTYPE2CLASS (CLUTTER_TYPE_ACTOR))))
+        {
+          g_ptr_array_free (actors, TRUE);
+          rb_raise (rb_eArgError, "Actor required");
+        }
+
+      actor = RVAL2GOBJ ((VALUE) g_ptr_array_index (actors, i));
+      g_ptr_array_index (actors, i) = actor;
     }
 
+  return actors;
+}
+
+static VALUE
+rbclt_container_add (int argc, VALUE *argv, VALUE self)
+{
+  ClutterContainer *container = CLUTTER_CONTAINER (RVAL2GOBJ (self));
+  GPtrArray *actors = rbclt_container_collect_actors (argc, argv);
+  guint i;
+
+  /* Clutter already coalesces the relayouts queued by each child so
+     there is nothing more to batch */
+  for (i = 0; i < actors->len; i++)
+    clutter_container_add_actor (container, g_ptr_array_index (actors, i));
+
+  g_ptr_array_free (actors, TRUE);
+
   return self;
 }
 
@@ -65,15 +169,14 @@ static VALUE
 rbclt_container_remove (int argc, VALUE *argv, VALUE self)
 {
   ClutterContainer *container = CLUTTER_CONTAINER (RVAL2GOBJ (self));
-  int i;
+  GPtrArray *actors = rbclt_container_collect_actors (argc, argv);
+  guint i;
 
-  for (i = 0; i < argc; i++)
-    {
-      gpointer actor = RVAL2GOBJ (argv[i]);
-      if (!CLUTTER_IS_ACTOR (actor))
-        rb_raise (rb_eArgError, "Actor required");
-      clutter_container_remove_actor (container, CLUTTER_ACTOR (actor));
-    }
+  for (i = 0; i < actors->len; i++)
+    clutter_container_remove_actor (container,
+                                    g_ptr_array_index (actors, i));
+
+  g_ptr_array_free (actors, TRUE);
 
   return self;
 }
@@ -84,30 +187,66 @@ rbclt_container_children_callback (ClutterActor *actor, gpointer data)
   rb_ary_push ((VALUE) data, GOBJ2RVAL (actor));
 }
 
+static void
+rbclt_container_check_child_callback (ClutterActor *actor, gpointer user_data)
+{
+  ChildrenCheckData *data = user_data;
+
+  if (data->matches
+      && (data->index >= RARRAY_LEN (data->snapshot)
+          || RVAL2GOBJ (RARRAY_PTR (data->snapshot)[data->index]) != actor))
+    data->matches = FALSE;
+
+  data->index++;
+}
+
 static VALUE
-rbclt_container_children (VALUE self)
+rbclt_container_get_children_snapshot (VALUE self)
 {
   ClutterContainer *container = CLUTTER_CONTAINER (RVAL2GOBJ (self));
-  VALUE ary = rb_ary_new ();
+  VALUE snapshot = rb_attr_get (self, id_children_snapshot);
 
+  if (TYPE (snapshot) == T_ARRAY)
+    {
+      ChildrenCheckData data;
+
+      data.snapshot = snapshot;
+      data.index = 0;
+      data.matches = TRUE;
+
+      clutter_container_foreach (container,
+                                 rbclt_container_check_child_callback,
+                                 &data);
+
+      if (data.matches && data.index == RARRAY_LEN (snapshot))
+        return snapshot;
+    }
+
+  snapshot = rb_ary_new ();
   clutter_container_foreach (container, rbclt_container_children_callback,
-                             (gpointer) ary);
+                             (gpointer) snapshot);
+  rb_obj_freeze (snapshot);
+  rb_ivar_set (self, id_children_snapshot, snapshot);
 
-  return ary;
+  return snapshot;
 }
 
-static void
-rbclt_container_each_callback (ClutterActor *actor, gpointer data)
+static VALUE
+rbclt_container_children (VALUE self)
 {
-  rb_yield (GOBJ2RVAL (actor));
+  return rbclt_container_get_children_snapshot (self);
 }
 
 static VALUE
 rbclt_container_each (VALUE self)
 {
-  ClutterContainer *container = CLUTTER_CONTAINER (RVAL2GOBJ (self));
+  VALUE children = rbclt_container_get_children_snapshot (self);
+  long i;
 
-  clutter_container_foreach (container, rbclt_container_each_callback, NULL);
+  /* The snapshot is never modified so this is safe even if the block
+     adds or removes children */
+  for (i = 0; i < RARRAY_LEN (children); i++)
+    rb_yield (RARRAY_PTR (children)[i]);
 
   return self;
 }
@@ -139,6 +278,7 @@ rbclt_container_raise_child (int argc, VALUE *argv, VALUE self)
                                  RVAL2GOBJ (actor),
                                  RVAL2GOBJ (sibling));
 
+
   return self;
 }
 
@@ -154,6 +294,7 @@ rbclt_container_lower_child (int argc, VALUE *argv, VALUE self)
                                  RVAL2GOBJ (actor),
                                  RVAL2GOBJ (sibling));
 
+
   return self;
 }
 
@@ -336,7 +477,11 @@ void
 rbclt_container_init ()
 {
   VALUE klass = G_DEF_INTERFACE2 (CLUTTER_TYPE_CONTAINER, "Container",
-                                  rbclt_c_clutter, rbclt_container_mark, NULL);
+                                  rbclt_c_clutter, NULL, NULL);
+
+  id_children_snapshot = rb_intern ("_prv_children");
+
+  rbclt_container_init_registry ();
 
   rb_define_method (klass, "add", rbclt_container_add, -1);
   rb_define_alias (klass, "<<", "add");
@@ -0,0 +1,337 @@
+/* Ruby bindings for the Clutter 'interactive canvas' library.
+ * Copyright (C) 2010  Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#include <rbgobject.h>
+#include <clutter/clutter.h>
+#include <math.h>
+
+#include "rbclutter.h"
+#include "rbcltcurve.h"
+
+/* Number of Newton-Raphson iterations used to find the parameter of
+   a bezier curve for a given progress before falling back to
+   bisection */
+#define BEZIER_NEWTON_ITERATIONS 8
+#define BEZIER_EPSILON 1e-6
+
+static VALUE rbclt_c_curve;
+
+static void
+rbclt_curve_free_data (void *data)
+{
+  rbclt_curve_free (data);
+}
+
+void
+rbclt_curve_free (RBCLTCurve *curve)
+{
+  if (curve->type == RBCLT_CURVE_LINEAR)
+    g_free (curve->u.linear.values);
+
+  g_slice_free (RBCLTCurve, curve);
+}
+
+RBCLTCurve *
+rbclt_curve_copy (const RBCLTCurve *curve)
+{
+  RBCLTCurve *copy = g_slice_dup (RBCLTCurve, curve);
+
+  if (curve->type == RBCLT_CURVE_LINEAR)
+    copy->u.linear.values = g_memdup (curve->u.linear.values,
+                                      sizeof (gdouble)
+                                      * curve->u.linear.n_values);
+
+  return copy;
+}
+
+gboolean
+rbclt_is_kind_of_curve (VALUE self)
+{
+  return (TYPE (self) == T_DATA
+          && RDATA (self)->dfree == rbclt_curve_free_data);
+}
+
+RBCLTCurve *
+rbclt_curve_get_pointer (VALUE self)
+{
+  RBCLTCurve *curve;
+
+  if (!rbclt_is_kind_of_curve (self))
+    rb_raise (rb_eTypeError, "wrong argument type");
+
+  Data_Get_Struct (self, RBCLTCurve, curve);
+
+  return curve;
+}
+
+static VALUE
+rbclt_curve_wrap (VALUE klass, RBCLTCurve *curve)
+{
+  return Data_Wrap_Struct (klass, NULL, rbclt_curve_free_data, curve);
+}
+
+VALUE
+rbclt_curve_to_value (RBCLTCurve *curve)
+{
+  return rbclt_curve_wrap (rbclt_c_curve, curve);
+}
+
+static gdouble
+rbclt_curve_bezier_coord (gdouble t, gdouble p1, gdouble p2)
+{
+  /* One dimension of a cubic bezier with the end points fixed at 0
+     and 1 */
+  gdouble c = 3.0 * p1;
+  gdouble b = 3.0 * (p2 - p1) - c;
+  gdouble a = 1.0 - c - b;
+
+  return ((a * t + b) * t + c) * t;
+}
+
+static gdouble
+rbclt_curve_bezier_slope (gdouble t, gdouble p1, gdouble p2)
+{
+  gdouble c = 3.0 * p1;
+  gdouble b = 3.0 * (p2 - p1) - c;
+  gdouble a = 1.0 - c - b;
+
+  return (3.0 * a * t + 2.0 * b) * t + c;
+}
+
+static gdouble
+rbclt_curve_evaluate_bezier (const RBCLTCurve *curve, gdouble progress)
+{
+  gdouble x1 = curve->u.bezier.x1, x2 = curve->u.bezier.x2;
+  gdouble t = progress, lo = 0.0, hi = 1.0, x, slope;
+  int i;
+
+  /* Find the parameter t where the x coordinate equals the progress
+     and then return the y coordinate at that point */
+  for (i = 0; i < BEZIER_NEWTON_ITERATIONS; i++)
+    {
+      x = rbclt_curve_bezier_coord (t, x1, x2) - progress;
+
+      if (fabs (x) < BEZIER_EPSILON)
+        goto found;
+
+      slope = rbclt_curve_bezier_slope (t, x1, x2);
+
+      if (fabs (slope) < BEZIER_EPSILON)
+        break;
+
+      t -= x / slope;
+    }
+
+  /* Newton's method didn't converge so use bisection instead. The x
+     coordinate is always increasing because the control points are
+     limited to the range [0,1] */
+  t = progress;
+  while (hi - lo > BEZIER_EPSILON)
+    {
+      x = rbclt_curve_bezier_coord (t, x1, x2);
+
+      if (fabs (x - progress) < BEZIER_EPSILON)
+        break;
+      else if (x < progress)
+        lo = t;
+      else
+        hi = t;
+
+      t = (lo + hi) / 2.0;
+    }
+
+ found:
+  return rbclt_curve_bezier_coord (t, curve->u.bezier.y1, curve->u.bezier.y2);
+}
+
+static gdouble
+rbclt_curve_evaluate_linear (const RBCLTCurve *curve, gdouble progress)
+{
+  const gdouble *values = curve->u.linear.values;
+  gdouble pos = progress * (curve->u.linear.n_values - 1);
+  guint index = pos;
+
+  if (index >= curve->u.linear.n_values - 1)
+    return values[curve->u.linear.n_values - 1];
+
+  return values[index] + (values[index + 1] - values[index]) * (pos - index);
+}
+
+gdouble
+rbclt_curve_evaluate (const RBCLTCurve *curve, gdouble progress)
+{
+  if (progress <= 0.0)
+    progress = 0.0;
+  else if (progress >= 1.0)
+    progress = 1.0;
+
+  switch (curve->type)
+    {
+    case RBCLT_CURVE_CUBIC_BEZIER:
+      return rbclt_curve_evaluate_bezier (curve, progress);
+
+    case RBCLT_CURVE_LINEAR:
+      return rbclt_curve_evaluate_linear (curve, progress);
+
+    case RBCLT_CURVE_SPRING:
+      /* A damped oscillation that has settled when the animation
+         finishes */
+      if (progress >= 1.0)
+        return 1.0;
+      return 1.0 - (exp (-curve->u.spring.damping * progress)
+                    * cos (curve->u.spring.oscillations * 2.0 * G_PI
+                           * progress));
+
+    case RBCLT_CURVE_STEPS:
+      if (curve->u.steps.jump_start)
+        return MIN (ceil (progress * curve->u.steps.n_steps)
+                    / curve->u.steps.n_steps, 1.0);
+      else
+        return floor (progress * curve->u.steps.n_steps)
+          / curve->u.steps.n_steps;
+    }
+
+  return progress;
+}
+
+gdouble
+rbclt_curve_alpha_func (ClutterAlpha *alpha, gpointer data)
+{
+  ClutterTimeline *timeline = clutter_alpha_get_timeline (alpha);
+
+  if (timeline == NULL)
+    return 0.0;
+
+  return rbclt_curve_evaluate (data, clutter_timeline_get_progress (timeline));
+}
+
+static VALUE
+rbclt_curve_cubic_bezier (VALUE klass, VALUE x1, VALUE y1, VALUE x2, VALUE y2)
+{
+  RBCLTCurve *curve;
+  gdouble x1_num = NUM2DBL (x1), x2_num = NUM2DBL (x2);
+
+  if (x1_num < 0.0 || x1_num > 1.0 || x2_num < 0.0 || x2_num > 1.0)
+    rb_raise (rb_eArgError, "the x coordinates of the control points "
+              "must be in the range [0,1]");
+
+  curve = g_slice_new (RBCLTCurve);
+  curve->type = RBCLT_CURVE_CUBIC_BEZIER;
+  curve->u.bezier.x1 = x1_num;
+  curve->u.bezier.y1 = NUM2DBL (y1);
+  curve->u.bezier.x2 = x2_num;
+  curve->u.bezier.y2 = NUM2DBL (y2);
+
+  return rbclt_curve_wrap (klass, curve);
+}
+
+static VALUE
+rbclt_curve_linear (VALUE klass, VALUE values)
+{
+  RBCLTCurve *curve;
+  VALUE self;
+  long i, n_values;
+
+  values = rb_convert_type (values, T_ARRAY, "Array", "to_ary");
+  n_values = RARRAY_LEN (values);
+
+  if (n_values < 2)
+    rb_raise (rb_eArgError, "at least two values are needed");
+
+  /* The curve is wrapped before converting the values so that the
+     garbage collector frees the array if one of them raises an
+     exception. n_values only counts the values converted so far */
+  curve = g_slice_new (RBCLTCurve);
+  curve->type = RBCLT_CURVE_LINEAR;
+  curve->u.linear.n_values = 0;
+  curve->u.linear.values = g_new (gdouble, n_values);
+  self = rbclt_curve_wrap (klass, curve);
+
+  for (i = 0; i < n_values && i < RARRAY_LEN (values); i++)
+    {
+      curve->u.linear.values[i] = NUM2DBL (RARRAY_PTR (values)[i]);
+      curve->u.linear.n_values++;
+    }
+
+  if (curve->u.linear.n_values < 2)
+    rb_raise (rb_eArgError, "at least two values are needed");
+
+  return self;
+}
+
+static VALUE
+rbclt_curve_spring (int argc, VALUE *argv, VALUE klass)
+{
+  VALUE oscillations, damping;
+  RBCLTCurve *curve;
+
+  rb_scan_args (argc, argv, "02", &oscillations, &damping);
+
+  curve = g_slice_new (RBCLTCurve);
+  curve->type = RBCLT_CURVE_SPRING;
+  curve->u.spring.oscillations = NIL_P (oscillations)
+    ? 3.0 : NUM2DBL (oscillations);
+  curve->u.spring.damping = NIL_P (damping) ? 6.0 : NUM2DBL (damping);
+
+  return rbclt_curve_wrap (klass, curve);
+}
+
+static VALUE
+rbclt_curve_steps (int argc, VALUE *argv, VALUE klass)
+{
+  VALUE n_steps, jump_start;
+  RBCLTCurve *curve;
+  guint n_steps_num;
+
+  rb_scan_args (argc, argv, "11", &n_steps, &jump_start);
+
+  if ((n_steps_num = NUM2UINT (n_steps)) < 1)
+    rb_raise (rb_eArgError, "at least one step is needed");
+
+  curve = g_slice_new (RBCLTCurve);
+  curve->type = RBCLT_CURVE_STEPS;
+  curve->u.steps.n_steps = n_steps_num;
+  curve->u.steps.jump_start = RTEST (jump_start);
+
+  return rbclt_curve_wrap (klass, curve);
+}
+
+static VALUE
+rbclt_curve_value_at (VALUE self, VALUE progress)
+{
+  return rb_float_new (rbclt_curve_evaluate (rbclt_curve_get_pointer (self),
+                                             NUM2DBL (progress)));
+}
+
+void
+rbclt_curve_init ()
+{
+  VALUE klass = rb_define_class_under (rbclt_c_clutter, "Curve", rb_cObject);
+  rbclt_c_curve = klass;
+
+  rb_undef_alloc_func (klass);
+
+  rb_define_singleton_method (klass, "cubic_bezier",
+                              rbclt_curve_cubic_bezier, 4);
+  rb_define_singleton_method (klass, "linear", rbclt_curve_linear, 1);
+  rb_define_singleton_method (klass, "spring", rbclt_curve_spring, -1);
+  rb_define_singleton_method (klass, "steps", rbclt_curve_steps, -1);
+
+  rb_define_method (klass, "value_at", rbclt_curve_value_at, 1);
+}
@@ -0,0 +1,81 @@
+/* Ruby bindings for the Clutter 'interactive canvas' library.
+ * Copyright (C) 2010  Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#ifndef _RBCLT_CURVE_H
+#define _RBCLT_CURVE_H
+
+#include <ruby.h>
+#include <clutter/clutter.h>
+
+typedef struct _RBCLTCurve RBCLTCurve;
+
+typedef enum
+{
+  RBCLT_CURVE_CUBIC_BEZIER,
+  RBCLT_CURVE_LINEAR,
+  RBCLT_CURVE_SPRING,
+  RBCLT_CURVE_STEPS
+} RBCLTCurveType;
+
+struct _RBCLTCurve
+{
+  RBCLTCurveType type;
+
+  union
+  {
+    struct
+    {
+      gdouble x1, y1, x2, y2;
+    } bezier;
+
+    /* Values evenly spaced over the range of the progress */
+    struct
+    {
+      guint n_values;
+      gdouble *values;
+    } linear;
+
+    struct
+    {
+      gdouble oscillations, damping;
+    } spring;
+
+    struct
+    {
+      guint n_steps;
+      gboolean jump_start;
+    } steps;
+  } u;
+};
+
+gboolean rbclt_is_kind_of_curve (VALUE self);
+RBCLTCurve *rbclt_curve_get_pointer (VALUE self);
+
+VALUE rbclt_curve_to_value (RBCLTCurve *curve);
+
+RBCLTCurve *rbclt_curve_copy (const RBCLTCurve *curve);
+void rbclt_curve_free (RBCLTCurve *curve);
+
+gdouble rbclt_curve_evaluate (const RBCLTCurve *curve, gdouble progress);
+
+/* A ClutterAlphaFunc that evaluates the curve passed as the user
+   data at the progress of the alpha's timeline */
+gdouble rbclt_curve_alpha_func (ClutterAlpha *alpha, gpointer data);
+
+#endif /* _RBCLT_CURVE_H */
@@ -22,12 +22,20 @@
 
 #include "rbclutter.h"
 #include "rbcltcallbackfunc.h"
+#include "rbcltstats.h"
 
 static gboolean
 rbclt_frame_source_callback (gpointer data)
 {
-  return RTEST (rbclt_callback_func_invoke ((RBCLTCallbackFunc *) data,
-                                            0, NULL));
+  gdouble start = rbclt_stats_begin ();
+  gboolean ret;
+
+  ret = RTEST (rbclt_callback_func_invoke ((RBCLTCallbackFunc *) data,
+                                           0, NULL));
+
+  rbclt_stats_end (RBCLT_STATS_FRAME_SOURCE, start);
+
+  return ret;
 }
 
 static VALUE
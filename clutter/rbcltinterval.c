@@ -21,6 +21,7 @@
 #include <clutter/clutter.h>
 
 #include "rbclutter.h"
+#include "rbcoglattributearray.h"
 
 typedef struct _InitializeData InitializeData;
 
@@ -177,13 +178,189 @@ rbclt_interval_set_interval (VALUE self, VALUE initial_value, VALUE final_value)
   return self;
 }
 
+/* Intervals of these types are interpolated directly instead of going
+   through clutter_interval_compute_value. This is only done for plain
+   ClutterIntervals because a subclass may override compute_value */
+typedef enum
+{
+  RBCLT_INTERVAL_GENERIC,
+  RBCLT_INTERVAL_INTEGER,
+  RBCLT_INTERVAL_FLOAT,
+  RBCLT_INTERVAL_COLOR,
+  RBCLT_INTERVAL_VERTEX
+} RBCLTIntervalKind;
+
+static gdouble
+rbclt_interval_value_to_double (const GValue *value)
+{
+  switch (G_TYPE_FUNDAMENTAL (G_VALUE_TYPE (value)))
+    {
+    case G_TYPE_INT: return g_value_get_int (value);
+    case G_TYPE_UINT: return g_value_get_uint (value);
+    case G_TYPE_LONG: return g_value_get_long (value);
+    case G_TYPE_ULONG: return g_value_get_ulong (value);
+    case G_TYPE_INT64: return g_value_get_int64 (value);
+    case G_TYPE_UINT64: return g_value_get_uint64 (value);
+    case G_TYPE_CHAR: return g_value_get_char (value);
+    case G_TYPE_UCHAR: return g_value_get_uchar (value);
+    case G_TYPE_FLOAT: return g_value_get_float (value);
+    case G_TYPE_DOUBLE: return g_value_get_double (value);
+    }
+
+  return 0.0;
+}
+
+static RBCLTIntervalKind
+rbclt_interval_kind_for_type (GType type)
+{
+  switch (G_TYPE_FUNDAMENTAL (type))
+    {
+    case G_TYPE_INT:
+    case G_TYPE_UINT:
+    case G_TYPE_INT64:
+    case G_TYPE_UCHAR:
+      return RBCLT_INTERVAL_INTEGER;
+
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+      return RBCLT_INTERVAL_FLOAT;
+
+    case G_TYPE_BOXED:
+      if (type == CLUTTER_TYPE_COLOR)
+        return RBCLT_INTERVAL_COLOR;
+      else if (type == CLUTTER_TYPE_VERTEX)
+        return RBCLT_INTERVAL_VERTEX;
+      break;
+    }
+
+  return RBCLT_INTERVAL_GENERIC;
+}
+
+/* Checks that Clutter interpolates the type linearly by computing the
+   middle of a sample interval. It would use a different function if
+   one has been registered with
+   clutter_interval_register_progress_func and there is no API to look
+   those up */
+static gboolean
+rbclt_interval_check_linear (GType type, RBCLTIntervalKind kind)
+{
+  static const ClutterColor color_a = { 0, 0, 0, 0 };
+  static const ClutterColor color_b = { 200, 200, 200, 200 };
+  static const ClutterVertex vertex_a = { 0.0f, 0.0f, 0.0f };
+  static const ClutterVertex vertex_b = { 200.0f, 200.0f, 200.0f };
+  GValue a = { 0, }, b = { 0, }, result = { 0, };
+  ClutterInterval *interval;
+  gboolean ret = FALSE;
+
+  g_value_init (&a, type);
+  g_value_init (&b, type);
+  g_value_init (&result, type);
+
+  if (kind == RBCLT_INTERVAL_COLOR)
+    {
+      g_value_set_boxed (&a, &color_a);
+      g_value_set_boxed (&b, &color_b);
+    }
+  else if (kind == RBCLT_INTERVAL_VERTEX)
+    {
+      g_value_set_boxed (&a, &vertex_a);
+      g_value_set_boxed (&b, &vertex_b);
+    }
+  else
+    {
+      GValue int_value = { 0, };
+
+      g_value_init (&int_value, G_TYPE_INT);
+      g_value_transform (&int_value, &a);
+      g_value_set_int (&int_value, 200);
+      g_value_transform (&int_value, &b);
+    }
+
+  interval = g_object_ref_sink (clutter_interval_new_with_values (type,
+                                                                  &a, &b));
+
+  if (clutter_interval_compute_value (interval, 0.25, &result))
+    {
+      if (kind == RBCLT_INTERVAL_COLOR)
+        {
+          const ClutterColor *color = g_value_get_boxed (&result);
+          ret = (color->red == 50 && color->green == 50
+                 && color->blue == 50 && color->alpha == 50);
+        }
+      else if (kind == RBCLT_INTERVAL_VERTEX)
+        {
+          const ClutterVertex *vertex = g_value_get_boxed (&result);
+          ret = (vertex->x == 50.0f && vertex->y == 50.0f
+                 && vertex->z == 50.0f);
+        }
+      else
+        ret = rbclt_interval_value_to_double (&result) == 50.0;
+    }
+
+  g_object_unref (interval);
+  g_value_unset (&a);
+  g_value_unset (&b);
+  g_value_unset (&result);
+
+  return ret;
+}
+
+static RBCLTIntervalKind
+rbclt_interval_get_kind (ClutterInterval *interval)
+{
+  /* Maps each value type to its kind, or to RBCLT_INTERVAL_GENERIC if
+     it can't use the fast path. The check is only done once per type
+     because progress functions are normally registered when the type
+     is created */
+  static GHashTable *kinds = NULL;
+  GType type = clutter_interval_get_value_type (interval);
+  RBCLTIntervalKind kind;
+  gpointer value;
+
+  if (G_OBJECT_TYPE (interval) != CLUTTER_TYPE_INTERVAL)
+    return RBCLT_INTERVAL_GENERIC;
+
+  if (kinds == NULL)
+    kinds = g_hash_table_new (NULL, NULL);
+
+  if (g_hash_table_lookup_extended (kinds, GSIZE_TO_POINTER (type),
+                                    NULL, &value))
+    return GPOINTER_TO_INT (value);
+
+  kind = rbclt_interval_kind_for_type (type);
+  if (kind != RBCLT_INTERVAL_GENERIC
+      && !rbclt_interval_check_linear (type, kind))
+    kind = RBCLT_INTERVAL_GENERIC;
+
+  g_hash_table_insert (kinds, GSIZE_TO_POINTER (type),
+                       GINT_TO_POINTER (kind));
+
+  return kind;
+}
+
 static VALUE
 rbclt_interval_compute_value (VALUE self, VALUE factor)
 {
   ClutterInterval *interval = CLUTTER_INTERVAL (RVAL2GOBJ (self));
+  RBCLTIntervalKind kind = rbclt_interval_get_kind (interval);
   GValue gval = { 0, };
   VALUE result;
 
+  if (kind == RBCLT_INTERVAL_INTEGER || kind == RBCLT_INTERVAL_FLOAT)
+    {
+      gdouble a, b, v;
+
+      a = rbclt_interval_value_to_double
+        (clutter_interval_peek_initial_value (interval));
+      b = rbclt_interval_value_to_double
+        (clutter_interval_peek_final_value (interval));
+      v = a + (b - a) * NUM2DBL (factor);
+
+      /* Clutter truncates interpolated integers */
+      return (kind == RBCLT_INTERVAL_INTEGER
+              ? LL2NUM ((gint64) v) : rb_float_new (v));
+    }
+
   g_value_init (&gval, clutter_interval_get_value_type (interval));
   clutter_interval_compute_value (interval, NUM2DBL (factor), &gval);
   result = GVAL2RVAL (&gval);
@@ -192,6 +369,136 @@ rbclt_interval_compute_value (VALUE self, VALUE factor)
   return result;
 }
 
+static VALUE
+rbclt_interval_compute_many (int argc, VALUE *argv, VALUE self)
+{
+  ClutterInterval *interval = CLUTTER_INTERVAL (RVAL2GOBJ (self));
+  RBCLTIntervalKind kind = rbclt_interval_get_kind (interval);
+  const GValue *initial = clutter_interval_peek_initial_value (interval);
+  const GValue *final = clutter_interval_peek_final_value (interval);
+  VALUE progress, output;
+  RBCoglAttributeArray *array;
+  CoglAttributeType output_type;
+  int n_components;
+  float *factors;
+  long n_factors, i;
+
+  rb_scan_args (argc, argv, "11", &progress, &output);
+
+  /* The progress values can be an array of numbers or packed floats
+     in a String or Cogl::AttributeArray */
+  if (TYPE (progress) == T_ARRAY)
+    {
+      VALUE packed
+        = rb_cogl_attribute_array_new (COGL_ATTRIBUTE_TYPE_FLOAT,
+                                       RARRAY_LEN (progress));
+
+      array = rb_cogl_attribute_array_get_pointer (packed);
+      for (i = 0; i < array->length && i < RARRAY_LEN (progress); i++)
+        rb_cogl_attribute_array_store (array, i, RARRAY_PTR (progress)[i]);
+
+      progress = packed;
+    }
+
+  factors = rb_cogl_get_packed_floats (&progress, &n_factors);
+
+  switch (kind)
+    {
+    case RBCLT_INTERVAL_GENERIC:
+      {
+        GValue gval = { 0, };
+        VALUE result = rb_ary_new2 (n_factors);
+
+        g_value_init (&gval, clutter_interval_get_value_type (interval));
+        for (i = 0; i < n_factors; i++)
+          {
+            clutter_interval_compute_value (interval, factors[i], &gval);
+            rb_ary_push (result, GVAL2RVAL (&gval));
+          }
+        g_value_unset (&gval);
+
+        return result;
+      }
+
+    case RBCLT_INTERVAL_COLOR:
+      output_type = COGL_ATTRIBUTE_TYPE_UNSIGNED_BYTE;
+      n_components = 4;
+      break;
+
+    case RBCLT_INTERVAL_VERTEX:
+      output_type = COGL_ATTRIBUTE_TYPE_FLOAT;
+      n_components = 3;
+      break;
+
+    default:
+      output_type = COGL_ATTRIBUTE_TYPE_FLOAT;
+      n_components = 1;
+      break;
+    }
+
+  /* An existing array can be passed to avoid allocating a new one
+     each time */
+  if (NIL_P (output))
+    output = rb_cogl_attribute_array_new (output_type,
+                                          n_factors * n_components);
+  else
+    {
+      rb_cogl_assert_is_kind_of_attribute_array (output);
+      array = rb_cogl_attribute_array_get_pointer (output);
+
+      if (array->type != output_type
+          || array->length != n_factors * n_components)
+        rb_raise (rb_eArgError, "output array does not have the right "
+                  "type or length");
+    }
+
+  array = rb_cogl_attribute_array_get_pointer (output);
+
+  if (kind == RBCLT_INTERVAL_COLOR)
+    {
+      const ClutterColor *a = g_value_get_boxed (initial);
+      const ClutterColor *b = g_value_get_boxed (final);
+      guint8 *out = array->data;
+
+      /* This matches clutter_color_interpolate */
+      for (i = 0; i < n_factors; i++)
+        {
+          *(out++) = a->red + (b->red - a->red) * factors[i];
+          *(out++) = a->green + (b->green - a->green) * factors[i];
+          *(out++) = a->blue + (b->blue - a->blue) * factors[i];
+          *(out++) = a->alpha + (b->alpha - a->alpha) * factors[i];
+        }
+    }
+  else if (kind == RBCLT_INTERVAL_VERTEX)
+    {
+      const ClutterVertex *a = g_value_get_boxed (initial);
+      const ClutterVertex *b = g_value_get_boxed (final);
+      float *out = array->data;
+
+      for (i = 0; i < n_factors; i++)
+        {
+          *(out++) = a->x + (b->x - a->x) * factors[i];
+          *(out++) = a->y + (b->y - a->y) * factors[i];
+          *(out++) = a->z + (b->z - a->z) * factors[i];
+        }
+    }
+  else
+    {
+      gdouble a = rbclt_interval_value_to_double (initial);
+      gdouble b = rbclt_interval_value_to_double (final);
+      float *out = array->data;
+
+      if (kind == RBCLT_INTERVAL_INTEGER)
+        for (i = 0; i < n_factors; i++)
+          out[i] = (gint64) (a + (b - a) * factors[i]);
+      else
+        for (i = 0; i < n_factors; i++)
+          out[i] = a + (b - a) * factors[i];
+    }
+
+  return output;
+}
+
 static VALUE
 rbclt_interval_validate (VALUE self, VALUE pspec_arg)
 {
@@ -228,6 +535,7 @@ rbclt_interval_init ()
   rb_define_method (klass, "set_interval", rbclt_interval_set_interval, 2);
   rb_define_method (klass, "compute_value", rbclt_interval_compute_value, 1);
   rb_define_alias (klass, "compute", "compute_value");
+  rb_define_method (klass, "compute_many", rbclt_interval_compute_many, -1);
   rb_define_method (klass, "validate", rbclt_interval_validate, 1);
   rb_define_method (klass, "interval", rbclt_interval_get_interval, 0);
 
@@ -0,0 +1,593 @@
+/* Ruby bindings for the Clutter 'interactive canvas' library.
+ * Copyright (C) 2010  Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#include <rbgobject.h>
+#include <clutter/clutter.h>
+#include <math.h>
+
+#include "rbclutter.h"
+#include "rbcltcallbackfunc.h"
+
+/* A list view is a group that shows the rows of a model using only
+   enough actors to fill its height. The actors are created by a Ruby
+   block and are reused for different rows as the view scrolls. Row
+   r is always shown by actor r % n_actors so scrolling by one row
+   only needs one actor to be rebound */
+
+#define RBCLT_TYPE_LIST_VIEW (rbclt_list_view_object_get_type ())
+#define RBCLT_LIST_VIEW(obj)                                            \
+  (G_TYPE_CHECK_INSTANCE_CAST ((obj), RBCLT_TYPE_LIST_VIEW, RBCLTListView))
+
+typedef struct _RBCLTListView RBCLTListView;
+typedef struct _RBCLTListViewClass RBCLTListViewClass;
+
+enum
+  {
+    RBCLT_LIST_VIEW_ROW_ADDED,
+    RBCLT_LIST_VIEW_ROW_REMOVED,
+    RBCLT_LIST_VIEW_ROW_CHANGED,
+    RBCLT_LIST_VIEW_SORT_CHANGED,
+    RBCLT_LIST_VIEW_FILTER_CHANGED,
+
+    RBCLT_LIST_VIEW_N_HANDLERS
+  };
+
+struct _RBCLTListView
+{
+  ClutterGroup parent;
+
+  ClutterModel *model;
+  gulong model_handlers[RBCLT_LIST_VIEW_N_HANDLERS];
+
+  gfloat row_height;
+  gfloat scroll_offset;
+  /* The height the rows were last laid out for */
+  gfloat viewport_height;
+
+  RBCLTCallbackFunc *create_func;
+  RBCLTCallbackFunc *bind_func;
+
+  /* The row actors. These are kept when the view shrinks so that
+     they can be reused when it grows again. An actor that is removed
+     from the group some other way loses its slot */
+  GPtrArray *actors;
+  /* The row that each actor is showing or -1 if it needs rebinding */
+  GArray *bound_rows;
+
+  guint repaint_func;
+};
+
+struct _RBCLTListViewClass
+{
+  ClutterGroupClass parent_class;
+};
+
+GType rbclt_list_view_object_get_type (void) G_GNUC_CONST;
+
+G_DEFINE_TYPE (RBCLTListView, rbclt_list_view_object, CLUTTER_TYPE_GROUP);
+
+static void
+rbclt_list_view_invalidate (RBCLTListView *view)
+{
+  guint i;
+
+  for (i = 0; i < view->bound_rows->len; i++)
+    g_array_index (view->bound_rows, gint, i) = -1;
+}
+
+static void
+rbclt_list_view_remove_repaint_func (RBCLTListView *view)
+{
+  if (view->repaint_func)
+    {
+      clutter_threads_remove_repaint_func (view->repaint_func);
+      view->repaint_func = 0;
+    }
+}
+
+static void
+rbclt_list_view_refresh (RBCLTListView *view)
+{
+  ClutterActor *self = CLUTTER_ACTOR (view);
+  guint first_row, n_visible, n_rows, row, slot;
+
+  rbclt_list_view_remove_repaint_func (view);
+
+  if (view->row_height <= 0.0f || view->create_func == NULL)
+    return;
+
+  view->viewport_height = clutter_actor_get_height (self);
+  n_rows = view->model ? clutter_model_get_n_rows (view->model) : 0;
+  first_row = MAX (view->scroll_offset, 0.0f) / view->row_height;
+  n_visible = ceilf (view->viewport_height / view->row_height) + 1;
+
+  if (view->actors->len < n_visible)
+    {
+      /* Adding actors changes which actor shows each row */
+      rbclt_list_view_invalidate (view);
+
+      while (view->actors->len < n_visible)
+        {
+          VALUE actor_value
+            = rbclt_callback_func_invoke (view->create_func, 0, NULL);
+          gpointer actor = RVAL2GOBJ (actor_value);
+          gint unbound = -1;
+
+          if (!CLUTTER_IS_ACTOR (actor))
+            rb_raise (rb_eTypeError, "the row block must return an actor");
+
+          clutter_container_add_actor (CLUTTER_CONTAINER (view), actor);
+          g_ptr_array_add (view->actors, actor);
+          g_array_append_val (view->bound_rows, unbound);
+        }
+    }
+
+  for (row = first_row; row < first_row + view->actors->len; row++)
+    {
+      ClutterActor *actor;
+      gint *bound_row;
+
+      slot = row % view->actors->len;
+      actor = g_ptr_array_index (view->actors, slot);
+      bound_row = &g_array_index (view->bound_rows, gint, slot);
+
+      if (row >= n_rows)
+        {
+          clutter_actor_hide (actor);
+          *bound_row = -1;
+          continue;
+        }
+
+      if (*bound_row != row)
+        {
+          if (view->bind_func)
+            {
+              ClutterModelIter *iter
+                = clutter_model_get_iter_at_row (view->model, row);
+              VALUE args[2];
+
+              args[0] = GOBJ2RVAL (actor);
+              args[1] = GOBJ2RVAL (iter);
+              g_object_unref (iter);
+
+              rbclt_callback_func_invoke (view->bind_func, 2, args);
+            }
+
+          /* Only marked as bound once the block has returned so that
+             the row is tried again if it raised */
+          *bound_row = row;
+        }
+
+      clutter_actor_set_position (actor, 0.0f,
+                                  row * view->row_height
+                                  - view->scroll_offset);
+      clutter_actor_show (actor);
+    }
+}
+
+static VALUE
+rbclt_list_view_do_refresh (VALUE arg)
+{
+  rbclt_list_view_refresh ((RBCLTListView *) arg);
+
+  return Qnil;
+}
+
+static gboolean
+rbclt_list_view_refresh_cb (gpointer data)
+{
+  RBCLTListView *view = data;
+  int state = 0;
+
+  /* Returning FALSE removes the repaint function */
+  view->repaint_func = 0;
+
+  /* This is called from the master clock so an exception from one of
+     the blocks can't be allowed to unwind through Clutter. Instead it
+     is reported as a warning and the rows are left as they are */
+  rb_protect (rbclt_list_view_do_refresh, (VALUE) view, &state);
+
+  if (state)
+    {
+      VALUE message = rb_inspect (rb_gv_get ("$!"));
+
+      rb_warn ("list view refresh failed: %s", StringValueCStr (message));
+      rb_gv_set ("$!", Qnil);
+    }
+
+  return FALSE;
+}
+
+/* Changes are collected and the rows are updated once just before the
+   next frame is laid out so that appending many rows to the model
+   doesn't rebind the visible rows for each one */
+static void
+rbclt_list_view_queue_refresh (RBCLTListView *view)
+{
+  if (view->repaint_func == 0)
+    {
+      view->repaint_func
+        = clutter_threads_add_repaint_func (rbclt_list_view_refresh_cb,
+                                            view, NULL);
+      clutter_actor_queue_redraw (CLUTTER_ACTOR (view));
+    }
+}
+
+static void
+rbclt_list_view_on_rows_changed (ClutterModel *model, RBCLTListView *view)
+{
+  rbclt_list_view_invalidate (view);
+  rbclt_list_view_queue_refresh (view);
+}
+
+static void
+rbclt_list_view_on_row_changed (ClutterModel *model, ClutterModelIter *iter,
+                                RBCLTListView *view)
+{
+  guint row = clutter_model_iter_get_row (iter), slot;
+
+  if (view->actors->len == 0)
+    return;
+
+  /* With a filter the iterator's row doesn't match the visible row so
+     everything is rebound */
+  if (clutter_model_get_filter_set (model))
+    rbclt_list_view_invalidate (view);
+  else
+    {
+      slot = row % view->actors->len;
+      if (g_array_index (view->bound_rows, gint, slot) == row)
+        g_array_index (view->bound_rows, gint, slot) = -1;
+      else
+        return;
+    }
+
+  rbclt_list_view_queue_refresh (view);
+}
+
+static void
+rbclt_list_view_on_row_added (ClutterModel *model, ClutterModelIter *iter,
+                              RBCLTListView *view)
+{
+  rbclt_list_view_on_rows_changed (model, view);
+}
+
+static void
+rbclt_list_view_on_actor_removed (ClutterContainer *container,
+                                  ClutterActor *actor,
+                                  RBCLTListView *view)
+{
+  guint i;
+
+  for (i = 0; i < view->actors->len; i++)
+    if (g_ptr_array_index (view->actors, i) == actor)
+      {
+        g_ptr_array_remove_index (view->actors, i);
+        g_array_remove_index (view->bound_rows, i);
+
+        /* Removing a slot changes which actor shows each row */
+        rbclt_list_view_on_rows_changed (view->model, view);
+        break;
+      }
+}
+
+static void
+rbclt_list_view_release_model (RBCLTListView *view)
+{
+  guint i;
+
+  if (view->model)
+    {
+      for (i = 0; i < RBCLT_LIST_VIEW_N_HANDLERS; i++)
+        g_signal_handler_disconnect (view->model, view->model_handlers[i]);
+      g_object_unref (view->model);
+      view->model = NULL;
+    }
+}
+
+static void
+rbclt_list_view_set_model (RBCLTListView *view, ClutterModel *model)
+{
+  rbclt_list_view_release_model (view);
+
+  if (model)
+    {
+      view->model = g_object_ref (model);
+      view->model_handlers[RBCLT_LIST_VIEW_ROW_ADDED]
+        = g_signal_connect (model, "row-added",
+                            G_CALLBACK (rbclt_list_view_on_row_added), view);
+      /* Row-removed is emitted before the row is gone but the refresh
+         is deferred so it will see the new number of rows */
+      view->model_handlers[RBCLT_LIST_VIEW_ROW_REMOVED]
+        = g_signal_connect (model, "row-removed",
+                            G_CALLBACK (rbclt_list_view_on_row_added), view);
+      view->model_handlers[RBCLT_LIST_VIEW_ROW_CHANGED]
+        = g_signal_connect (model, "row-changed",
+                            G_CALLBACK (rbclt_list_view_on_row_changed),
+                            view);
+      view->model_handlers[RBCLT_LIST_VIEW_SORT_CHANGED]
+        = g_signal_connect (model, "sort-changed",
+                            G_CALLBACK (rbclt_list_view_on_rows_changed),
+                            view);
+      view->model_handlers[RBCLT_LIST_VIEW_FILTER_CHANGED]
+        = g_signal_connect (model, "filter-changed",
+                            G_CALLBACK (rbclt_list_view_on_rows_changed),
+                            view);
+    }
+
+  rbclt_list_view_on_rows_changed (model, view);
+}
+
+static void
+rbclt_list_view_allocate (ClutterActor *actor,
+                          const ClutterActorBox *box,
+                          ClutterAllocationFlags flags)
+{
+  RBCLTListView *view = RBCLT_LIST_VIEW (actor);
+
+  CLUTTER_ACTOR_CLASS (rbclt_list_view_object_parent_class)
+    ->allocate (actor, box, flags);
+
+  /* Actors can't be added during allocation so a change of height is
+     picked up on the next frame */
+  if (clutter_actor_box_get_height (box) != view->viewport_height)
+    rbclt_list_view_queue_refresh (view);
+}
+
+static void
+rbclt_list_view_dispose (GObject *object)
+{
+  RBCLTListView *view = RBCLT_LIST_VIEW (object);
+
+  /* The model is dropped directly rather than with set_model because
+     that would queue a refresh for a view that is going away */
+  rbclt_list_view_release_model (view);
+
+  /* The actors are destroyed along with the group. The slots are
+     cleared first so that removing them doesn't queue a refresh */
+  g_ptr_array_set_size (view->actors, 0);
+  g_array_set_size (view->bound_rows, 0);
+
+  G_OBJECT_CLASS (rbclt_list_view_object_parent_class)->dispose (object);
+
+  /* Destroying the group can still queue a relayout so the repaint
+     function is removed last */
+  rbclt_list_view_remove_repaint_func (view);
+}
+
+static void
+rbclt_list_view_finalize (GObject *object)
+{
+  RBCLTListView *view = RBCLT_LIST_VIEW (object);
+
+  /* The repaint function must never outlive the view */
+  rbclt_list_view_remove_repaint_func (view);
+
+  if (view->create_func)
+    rbclt_callback_func_destroy (view->create_func);
+  if (view->bind_func)
+    rbclt_callback_func_destroy (view->bind_func);
+
+  g_ptr_array_free (view->actors, TRUE);
+  g_array_free (view->bound_rows, TRUE);
+
+  G_OBJECT_CLASS (rbclt_list_view_object_parent_class)->finalize (object);
+}
+
+static void
+rbclt_list_view_object_class_init (RBCLTListViewClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
+
+  gobject_class->dispose = rbclt_list_view_dispose;
+  gobject_class->finalize = rbclt_list_view_finalize;
+
+  actor_class->allocate = rbclt_list_view_allocate;
+}
+
+static void
+rbclt_list_view_object_init (RBCLTListView *view)
+{
+  view->actors = g_ptr_array_new ();
+  view->bound_rows = g_array_new (FALSE, FALSE, sizeof (gint));
+  view->viewport_height = -1.0f;
+
+  g_signal_connect (view, "actor-removed",
+                    G_CALLBACK (rbclt_list_view_on_actor_removed), view);
+}
+
+static VALUE
+rbclt_list_view_initialize (int argc, VALUE *argv, VALUE self)
+{
+  VALUE model, row_height, create_func;
+  RBCLTListView *view;
+
+  rb_scan_args (argc, argv, "2&", &model, &row_height, &create_func);
+
+  view = g_object_new (RBCLT_TYPE_LIST_VIEW, NULL);
+  view->row_height = NUM2DBL (row_height);
+  clutter_actor_set_clip_to_allocation (CLUTTER_ACTOR (view), TRUE);
+
+  if (!NIL_P (create_func))
+    view->create_func = rbclt_callback_func_new (create_func);
+
+  rbclt_initialize_unowned (self, CLUTTER_ACTOR (view));
+
+  if (!NIL_P (model))
+    rbclt_list_view_set_model (view, RVAL2GOBJ (model));
+
+  return Qnil;
+}
+
+static VALUE
+rbclt_list_view_on_create_row (VALUE self)
+{
+  RBCLTListView *view = RBCLT_LIST_VIEW (RVAL2GOBJ (self));
+
+  if (view->create_func)
+    rbclt_callback_func_destroy (view->create_func);
+  view->create_func = rbclt_callback_func_new (rb_block_proc ());
+
+  rbclt_list_view_on_rows_changed (view->model, view);
+
+  return self;
+}
+
+static VALUE
+rbclt_list_view_on_bind_row (VALUE self)
+{
+  RBCLTListView *view = RBCLT_LIST_VIEW (RVAL2GOBJ (self));
+
+  if (view->bind_func)
+    rbclt_callback_func_destroy (view->bind_func);
+  view->bind_func = rbclt_callback_func_new (rb_block_proc ());
+
+  rbclt_list_view_on_rows_changed (view->model, view);
+
+  return self;
+}
+
+static VALUE
+rbclt_list_view_get_model (VALUE self)
+{
+  RBCLTListView *view = RBCLT_LIST_VIEW (RVAL2GOBJ (self));
+
+  return view->model ? GOBJ2RVAL (view->model) : Qnil;
+}
+
+static VALUE
+rbclt_list_view_set_model_value (VALUE self, VALUE model)
+{
+  RBCLTListView *view = RBCLT_LIST_VIEW (RVAL2GOBJ (self));
+
+  rbclt_list_view_set_model (view, NIL_P (model) ? NULL : RVAL2GOBJ (model));
+
+  return self;
+}
+
+static VALUE
+rbclt_list_view_get_row_height (VALUE self)
+{
+  RBCLTListView *view = RBCLT_LIST_VIEW (RVAL2GOBJ (self));
+
+  return rb_float_new (view->row_height);
+}
+
+static VALUE
+rbclt_list_view_set_row_height (VALUE self, VALUE row_height)
+{
+  RBCLTListView *view = RBCLT_LIST_VIEW (RVAL2GOBJ (self));
+
+  view->row_height = NUM2DBL (row_height);
+  rbclt_list_view_on_rows_changed (view->model, view);
+
+  return self;
+}
+
+static VALUE
+rbclt_list_view_get_scroll_offset (VALUE self)
+{
+  RBCLTListView *view = RBCLT_LIST_VIEW (RVAL2GOBJ (self));
+
+  return rb_float_new (view->scroll_offset);
+}
+
+static VALUE
+rbclt_list_view_set_scroll_offset (VALUE self, VALUE offset)
+{
+  RBCLTListView *view = RBCLT_LIST_VIEW (RVAL2GOBJ (self));
+
+  /* Only the rows that scroll into view need rebinding */
+  view->scroll_offset = NUM2DBL (offset);
+  rbclt_list_view_queue_refresh (view);
+
+  return self;
+}
+
+static VALUE
+rbclt_list_view_scroll_to_row (VALUE self, VALUE row)
+{
+  RBCLTListView *view = RBCLT_LIST_VIEW (RVAL2GOBJ (self));
+
+  view->scroll_offset = NUM2UINT (row) * view->row_height;
+  rbclt_list_view_queue_refresh (view);
+
+  return self;
+}
+
+static VALUE
+rbclt_list_view_refresh_value (VALUE self)
+{
+  rbclt_list_view_refresh (RBCLT_LIST_VIEW (RVAL2GOBJ (self)));
+
+  return self;
+}
+
+static VALUE
+rbclt_list_view_get_row_actor (VALUE self, VALUE row_value)
+{
+  RBCLTListView *view = RBCLT_LIST_VIEW (RVAL2GOBJ (self));
+  gint row = NUM2INT (row_value);
+  guint slot;
+
+  if (row < 0 || view->actors->len == 0)
+    return Qnil;
+
+  slot = row % view->actors->len;
+  if (g_array_index (view->bound_rows, gint, slot) != row)
+    return Qnil;
+
+  return GOBJ2RVAL (g_ptr_array_index (view->actors, slot));
+}
+
+static VALUE
+rbclt_list_view_get_n_row_actors (VALUE self)
+{
+  RBCLTListView *view = RBCLT_LIST_VIEW (RVAL2GOBJ (self));
+
+  return UINT2NUM (view->actors->len);
+}
+
+void
+rbclt_list_view_init ()
+{
+  VALUE klass = G_DEF_CLASS (RBCLT_TYPE_LIST_VIEW, "ListView",
+                             rbclt_c_clutter);
+
+  rb_define_method (klass, "initialize", rbclt_list_view_initialize, -1);
+  rb_define_method (klass, "on_create_row", rbclt_list_view_on_create_row, 0);
+  rb_define_method (klass, "on_bind_row", rbclt_list_view_on_bind_row, 0);
+  rb_define_method (klass, "model", rbclt_list_view_get_model, 0);
+  rb_define_method (klass, "set_model", rbclt_list_view_set_model_value, 1);
+  rb_define_method (klass, "row_height", rbclt_list_view_get_row_height, 0);
+  rb_define_method (klass, "set_row_height",
+                    rbclt_list_view_set_row_height, 1);
+  rb_define_method (klass, "scroll_offset",
+                    rbclt_list_view_get_scroll_offset, 0);
+  rb_define_method (klass, "set_scroll_offset",
+                    rbclt_list_view_set_scroll_offset, 1);
+  rb_define_method (klass, "scroll_to_row", rbclt_list_view_scroll_to_row, 1);
+  rb_define_method (klass, "refresh", rbclt_list_view_refresh_value, 0);
+  rb_define_method (klass, "row_actor", rbclt_list_view_get_row_actor, 1);
+  rb_define_method (klass, "n_row_actors",
+                    rbclt_list_view_get_n_row_actors, 0);
+
+  G_DEF_SETTERS (klass);
+}
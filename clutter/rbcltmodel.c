@@ -22,6 +22,7 @@
 
 #include "rbclutter.h"
 #include "rbcltcallbackfunc.h"
+#include "rbcltcolumnarmodel.h"
 
 typedef struct _SetColumnsData SetColumnsData;
 
@@ -375,14 +376,95 @@ rbclt_model_call_sort_func (ClutterModel *model,
                                               3, argv));
 }
 
+/* Compares two values of the same type without calling into Ruby.
+   Strings are compared in byte order */
+static gint
+rbclt_model_compare_values (const GValue *a, const GValue *b)
+{
+  gdouble da, db;
+
+  switch (G_TYPE_FUNDAMENTAL (G_VALUE_TYPE (a)))
+    {
+    case G_TYPE_STRING:
+      return g_strcmp0 (g_value_get_string (a), g_value_get_string (b));
+
+    case G_TYPE_INT64:
+      return (g_value_get_int64 (a) < g_value_get_int64 (b) ? -1
+              : g_value_get_int64 (a) > g_value_get_int64 (b) ? 1 : 0);
+
+    case G_TYPE_UINT64:
+      return (g_value_get_uint64 (a) < g_value_get_uint64 (b) ? -1
+              : g_value_get_uint64 (a) > g_value_get_uint64 (b) ? 1 : 0);
+
+    case G_TYPE_BOOLEAN:
+      da = g_value_get_boolean (a); db = g_value_get_boolean (b); break;
+    case G_TYPE_CHAR:
+      da = g_value_get_char (a); db = g_value_get_char (b); break;
+    case G_TYPE_UCHAR:
+      da = g_value_get_uchar (a); db = g_value_get_uchar (b); break;
+    case G_TYPE_INT:
+      da = g_value_get_int (a); db = g_value_get_int (b); break;
+    case G_TYPE_UINT:
+      da = g_value_get_uint (a); db = g_value_get_uint (b); break;
+    case G_TYPE_LONG:
+      da = g_value_get_long (a); db = g_value_get_long (b); break;
+    case G_TYPE_ULONG:
+      da = g_value_get_ulong (a); db = g_value_get_ulong (b); break;
+    case G_TYPE_ENUM:
+      da = g_value_get_enum (a); db = g_value_get_enum (b); break;
+    case G_TYPE_FLOAT:
+      da = g_value_get_float (a); db = g_value_get_float (b); break;
+    case G_TYPE_DOUBLE:
+      da = g_value_get_double (a); db = g_value_get_double (b); break;
+
+    default:
+      return 0;
+    }
+
+  return da < db ? -1 : da > db ? 1 : 0;
+}
+
+static gint
+rbclt_model_native_sort_func (ClutterModel *model,
+                              const GValue *a,
+                              const GValue *b,
+                              gpointer user_data)
+{
+  gint ret = rbclt_model_compare_values (a, b);
+
+  return GPOINTER_TO_INT (user_data) ? -ret : ret;
+}
+
 static VALUE
-rbclt_model_set_sort (VALUE self, VALUE column_arg)
+rbclt_model_set_sort (int argc, VALUE *argv, VALUE self)
 {
   ClutterModel *model = CLUTTER_MODEL (RVAL2GOBJ (self));
   RBCLTCallbackFunc *func;
-  guint column = NUM2UINT (column_arg);
+  VALUE column_arg, direction;
+  guint column;
 
-  if (rb_block_given_p ())
+  rb_scan_args (argc, argv, "11", &column_arg, &direction);
+
+  column = NUM2UINT (column_arg);
+
+  /* With a direction instead of a block the values are compared
+     natively */
+  if (!NIL_P (direction))
+    {
+      gboolean descending;
+
+      if (direction == ID2SYM (rb_intern ("ascending")))
+        descending = FALSE;
+      else if (direction == ID2SYM (rb_intern ("descending")))
+        descending = TRUE;
+      else
+        rb_raise (rb_eArgError, "sort direction must be :ascending "
+                  "or :descending");
+
+      clutter_model_set_sort (model, column, rbclt_model_native_sort_func,
+                              GINT_TO_POINTER (descending), NULL);
+    }
+  else if (rb_block_given_p ())
     {
       func = rbclt_callback_func_new (rb_block_proc ());
 
@@ -429,6 +511,203 @@ rbclt_model_set_filter (VALUE self)
   return self;
 }
 
+typedef enum
+  {
+    RBCLT_MODEL_FILTER_RANGE,
+    RBCLT_MODEL_FILTER_EQUAL,
+    RBCLT_MODEL_FILTER_PREFIX
+  } FilterOp;
+
+typedef struct _FilterPredicate FilterPredicate;
+
+struct _FilterPredicate
+{
+  guint column;
+  FilterOp op;
+  /* For a range either bound can be unset to leave it open */
+  GValue a, b;
+};
+
+typedef struct _NativeFilterData NativeFilterData;
+
+struct _NativeFilterData
+{
+  ClutterModel *model;
+  VALUE predicates;
+  guint n_predicates;
+  FilterPredicate *predicate_array;
+};
+
+static void
+rbclt_model_free_native_filter (NativeFilterData *data)
+{
+  guint i;
+
+  for (i = 0; i < data->n_predicates; i++)
+    {
+      if (G_IS_VALUE (&data->predicate_array[i].a))
+        g_value_unset (&data->predicate_array[i].a);
+      if (G_IS_VALUE (&data->predicate_array[i].b))
+        g_value_unset (&data->predicate_array[i].b);
+    }
+
+  g_free (data->predicate_array);
+  g_slice_free (NativeFilterData, data);
+}
+
+static gboolean
+rbclt_model_native_filter_func (ClutterModel *model,
+                                ClutterModelIter *iter,
+                                gpointer user_data)
+{
+  NativeFilterData *data = user_data;
+  gboolean ret = TRUE;
+  guint i;
+
+  for (i = 0; ret && i < data->n_predicates; i++)
+    {
+      const FilterPredicate *predicate = data->predicate_array + i;
+      GValue value = { 0, };
+
+      clutter_model_iter_get_value (iter, predicate->column, &value);
+
+      switch (predicate->op)
+        {
+        case RBCLT_MODEL_FILTER_RANGE:
+          ret = ((!G_IS_VALUE (&predicate->a)
+                  || rbclt_model_compare_values (&value, &predicate->a) >= 0)
+                 && (!G_IS_VALUE (&predicate->b)
+                     || rbclt_model_compare_values (&value,
+                                                    &predicate->b) <= 0));
+          break;
+
+        case RBCLT_MODEL_FILTER_EQUAL:
+          ret = rbclt_model_compare_values (&value, &predicate->a) == 0;
+          break;
+
+        case RBCLT_MODEL_FILTER_PREFIX:
+          ret = (g_value_get_string (&value) != NULL
+                 && g_str_has_prefix (g_value_get_string (&value),
+                                      g_value_get_string (&predicate->a)));
+          break;
+        }
+
+      g_value_unset (&value);
+    }
+
+  return ret;
+}
+
+static void
+rbclt_model_init_filter_value (GValue *gval, GType type, VALUE value)
+{
+  if (NIL_P (value))
+    return;
+
+  g_value_init (gval, type);
+  rbgobj_rvalue_to_gvalue (value, gval);
+}
+
+static VALUE
+rbclt_model_do_set_native_filter (VALUE arg)
+{
+  NativeFilterData *data = (NativeFilterData *) arg;
+  guint n_columns = clutter_model_get_n_columns (data->model);
+  guint i;
+
+  for (i = 0; i < data->n_predicates; i++)
+    {
+      FilterPredicate *predicate = data->predicate_array + i;
+      VALUE args = rb_convert_type (RARRAY_PTR (data->predicates)[i],
+                                    T_ARRAY, "Array", "to_ary");
+      long n_args = RARRAY_LEN (args) - 2;
+      GType type;
+      ID op;
+
+      if (n_args < 1)
+        rb_raise (rb_eArgError, "filter predicates must be arrays of "
+                  "[column, op, value...]");
+
+      predicate->column = NUM2UINT (RARRAY_PTR (args)[0]);
+      if (predicate->column >= n_columns)
+        rb_raise (rb_eArgError, "column out of range");
+
+      type = clutter_model_get_column_type (data->model, predicate->column);
+      op = rb_to_id (RARRAY_PTR (args)[1]);
+
+      if (op == rb_intern ("range") && n_args == 2)
+        {
+          predicate->op = RBCLT_MODEL_FILTER_RANGE;
+          rbclt_model_init_filter_value (&predicate->a, type,
+                                         RARRAY_PTR (args)[2]);
+          rbclt_model_init_filter_value (&predicate->b, type,
+                                         RARRAY_PTR (args)[3]);
+        }
+      else if (op == rb_intern ("equal") && n_args == 1)
+        {
+          predicate->op = RBCLT_MODEL_FILTER_EQUAL;
+          g_value_init (&predicate->a, type);
+          rbgobj_rvalue_to_gvalue (RARRAY_PTR (args)[2], &predicate->a);
+        }
+      else if (op == rb_intern ("prefix") && n_args == 1)
+        {
+          if (G_TYPE_FUNDAMENTAL (type) != G_TYPE_STRING)
+            rb_raise (rb_eArgError, "prefix filters need a string column");
+
+          predicate->op = RBCLT_MODEL_FILTER_PREFIX;
+          g_value_init (&predicate->a, G_TYPE_STRING);
+          g_value_set_string (&predicate->a,
+                              StringValueCStr (RARRAY_PTR (args)[2]));
+        }
+      else
+        rb_raise (rb_eArgError, "unknown filter predicate %s",
+                  rb_id2name (op));
+    }
+
+  /* The model takes ownership of the data from here */
+  clutter_model_set_filter (data->model, rbclt_model_native_filter_func,
+                            data,
+                            (GDestroyNotify) rbclt_model_free_native_filter);
+  data->model = NULL;
+
+  return Qnil;
+}
+
+static VALUE
+rbclt_model_free_unused_native_filter (VALUE arg)
+{
+  NativeFilterData *data = (NativeFilterData *) arg;
+
+  if (data->model)
+    rbclt_model_free_native_filter (data);
+
+  return Qnil;
+}
+
+static VALUE
+rbclt_model_set_native_filter (VALUE self, VALUE predicates)
+{
+  NativeFilterData *data;
+
+  if (RARRAY_LEN (predicates) < 1)
+    {
+      clutter_model_set_filter (CLUTTER_MODEL (RVAL2GOBJ (self)),
+                                NULL, NULL, NULL);
+      return self;
+    }
+
+  data = g_slice_new (NativeFilterData);
+  data->model = CLUTTER_MODEL (RVAL2GOBJ (self));
+  data->predicates = predicates;
+  data->n_predicates = RARRAY_LEN (predicates);
+  data->predicate_array = g_new0 (FilterPredicate, data->n_predicates);
+
+  rb_ensure (rbclt_model_do_set_native_filter, (VALUE) data,
+             rbclt_model_free_unused_native_filter, (VALUE) data);
+
+  return self;
+}
+
 static VALUE
 rbclt_model_filter_row (VALUE self, VALUE row)
 {
@@ -651,6 +930,184 @@ rbclt_model_each (VALUE self)
   return self;
 }
 
+typedef struct _RowsData RowsData;
+
+struct _RowsData
+{
+  ClutterModel *model;
+  ClutterModelIter *iter;
+  guint start, count;
+  VALUE columns_arg;
+  guint n_columns;
+  guint *columns;
+  GValue value;
+  VALUE result;
+};
+
+static void
+rbclt_model_rows_lookup_columns (RowsData *data)
+{
+  guint i, n_model_columns = clutter_model_get_n_columns (data->model);
+  VALUE columns = data->columns_arg;
+
+  /* The columns can be nil for all of the columns, a single column or
+     an array of columns. The columns of a ColumnarModel can also be
+     given by name */
+  if (NIL_P (columns))
+    {
+      data->n_columns = n_model_columns;
+      data->columns = g_new (guint, data->n_columns);
+      for (i = 0; i < data->n_columns; i++)
+        data->columns[i] = i;
+    }
+  else
+    {
+      columns = rb_Array (columns);
+      data->n_columns = RARRAY_LEN (columns);
+      data->columns = g_new (guint, data->n_columns);
+      for (i = 0; i < data->n_columns && i < RARRAY_LEN (columns); i++)
+        {
+          VALUE column = RARRAY_PTR (columns)[i];
+
+          if (RBCLT_IS_COLUMNAR_MODEL (data->model))
+            data->columns[i]
+              = rbclt_columnar_model_lookup_column (RBCLT_COLUMNAR_MODEL
+                                                    (data->model), column);
+          else if (!FIXNUM_P (column) || FIX2LONG (column) < 0
+                   || FIX2LONG (column) >= n_model_columns)
+            rb_raise (rb_eArgError, "column out of range");
+          else
+            data->columns[i] = FIX2LONG (column);
+        }
+      data->n_columns = i;
+    }
+}
+
+static VALUE
+rbclt_model_do_rows (VALUE arg)
+{
+  RowsData *data = (RowsData *) arg;
+  guint row, i;
+
+  rbclt_model_rows_lookup_columns (data);
+
+  /* Without a filter the columnar model can be read directly */
+  if (RBCLT_IS_COLUMNAR_MODEL (data->model)
+      && !clutter_model_get_filter_set (data->model))
+    {
+      RBCLTColumnarModel *model = RBCLT_COLUMNAR_MODEL (data->model);
+
+      for (row = data->start;
+           row < model->n_rows && row - data->start < data->count;
+           row++)
+        for (i = 0; i < data->n_columns; i++)
+          {
+            guint column = data->columns[i];
+            VALUE v = Qnil;
+
+            switch (model->kinds[column])
+              {
+              case RBCLT_COLUMN_INT:
+                v = INT2NUM (RBCLT_COLUMNAR_MODEL_VALUE (model, gint,
+                                                         column, row));
+                break;
+              case RBCLT_COLUMN_UINT:
+                v = UINT2NUM (RBCLT_COLUMNAR_MODEL_VALUE (model, guint,
+                                                          column, row));
+                break;
+              case RBCLT_COLUMN_BOOLEAN:
+                v = RBCLT_COLUMNAR_MODEL_VALUE (model, gint, column, row)
+                  ? Qtrue : Qfalse;
+                break;
+              case RBCLT_COLUMN_FLOAT:
+                v = rb_float_new (RBCLT_COLUMNAR_MODEL_VALUE (model, gfloat,
+                                                              column, row));
+                break;
+              case RBCLT_COLUMN_DOUBLE:
+                v = rb_float_new (RBCLT_COLUMNAR_MODEL_VALUE (model, gdouble,
+                                                              column, row));
+                break;
+              case RBCLT_COLUMN_STRING:
+                {
+                  const gchar *str
+                    = RBCLT_COLUMNAR_MODEL_VALUE (model, const gchar *,
+                                                  column, row);
+                  v = str ? rb_str_new2 (str) : Qnil;
+                }
+                break;
+              }
+
+            rb_ary_push (data->result, v);
+          }
+
+      return Qnil;
+    }
+
+  data->iter = clutter_model_get_iter_at_row (data->model, data->start);
+
+  if (data->iter == NULL)
+    return Qnil;
+
+  /* A single iterator is reused for all of the rows */
+  for (row = 0;
+       row < data->count && !clutter_model_iter_is_last (data->iter);
+       row++)
+    {
+      for (i = 0; i < data->n_columns; i++)
+        {
+          clutter_model_iter_get_value (data->iter, data->columns[i],
+                                        &data->value);
+          rb_ary_push (data->result, GVAL2RVAL (&data->value));
+          g_value_unset (&data->value);
+        }
+
+      clutter_model_iter_next (data->iter);
+    }
+
+  return Qnil;
+}
+
+static VALUE
+rbclt_model_free_rows_data (VALUE arg)
+{
+  RowsData *data = (RowsData *) arg;
+
+  if (G_IS_VALUE (&data->value))
+    g_value_unset (&data->value);
+  if (data->iter)
+    g_object_unref (data->iter);
+  g_free (data->columns);
+
+  return Qnil;
+}
+
+static VALUE
+rbclt_model_rows (int argc, VALUE *argv, VALUE self)
+{
+  ClutterModel *model = CLUTTER_MODEL (RVAL2GOBJ (self));
+  guint n_model_columns = clutter_model_get_n_columns (model);
+  VALUE start, count, columns;
+  RowsData data;
+
+  rb_scan_args (argc, argv, "21", &start, &count, &columns);
+
+  data.model = model;
+  data.iter = NULL;
+  data.start = NUM2UINT (start);
+  data.count = NUM2UINT (count);
+  data.columns_arg = columns;
+  data.n_columns = 0;
+  data.columns = NULL;
+  memset (&data.value, 0, sizeof (data.value));
+
+  data.result = rb_ary_new2 (MIN (data.count, 1024) * n_model_columns);
+
+  rb_ensure (rbclt_model_do_rows, (VALUE) &data,
+             rbclt_model_free_rows_data, (VALUE) &data);
+
+  return data.result;
+}
+
 static VALUE
 rbclt_model_resort (VALUE self)
 {
@@ -682,12 +1139,15 @@ rbclt_model_init ()
   rb_define_method (klass, "last_iter", rbclt_model_get_last_iter, 0);
   rb_define_method (klass, "get_iter_at_row", rbclt_model_get_iter_at_row, 1);
   rb_define_method (klass, "each", rbclt_model_each, 0);
+  rb_define_method (klass, "rows", rbclt_model_rows, -1);
   rb_define_method (klass, "sorting_column",
                     rbclt_model_get_sorting_column, 0);
   rb_define_method (klass, "set_sorting_column",
                     rbclt_model_set_sorting_column, 1);
-  rb_define_method (klass, "set_sort", rbclt_model_set_sort, 1);
+  rb_define_method (klass, "set_sort", rbclt_model_set_sort, -1);
   rb_define_method (klass, "set_filter", rbclt_model_set_filter, 0);
+  rb_define_method (klass, "set_native_filter",
+                    rbclt_model_set_native_filter, -2);
   rb_define_method (klass, "resort", rbclt_model_resort, 0);
   rb_define_method (klass, "filter_row?", rbclt_model_filter_row, 1);
   rb_define_method (klass, "filter_iter?", rbclt_model_filter_iter, 1);
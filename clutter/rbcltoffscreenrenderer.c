@@ -0,0 +1,348 @@
+/* Ruby bindings for the Clutter 'interactive canvas' library.
+ * Copyright (C) 2010  Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#include <rbgobject.h>
+#include <clutter/clutter.h>
+
+#include "rbclutter.h"
+#include "rbcoglhandle.h"
+
+/* An offscreen renderer paints actors into a texture through a
+   Cogl::Offscreen framebuffer and reads the pixels back. The texture
+   and framebuffer are created once so that a queue of scenes can be
+   rendered back to back without anything appearing on the stage */
+
+typedef struct _RBCLTOffscreenRenderer RBCLTOffscreenRenderer;
+
+struct _RBCLTOffscreenRenderer
+{
+  guint width, height;
+  CoglHandle texture;
+  CoglHandle offscreen;
+  /* Stage that actors without a parent are temporarily added to so
+     that they can be allocated and mapped */
+  ClutterStage *stage;
+};
+
+static void
+rbclt_offscreen_renderer_free (void *data)
+{
+  RBCLTOffscreenRenderer *renderer = data;
+
+  if (renderer->offscreen != COGL_INVALID_HANDLE)
+    cogl_handle_unref (renderer->offscreen);
+  if (renderer->texture != COGL_INVALID_HANDLE)
+    cogl_handle_unref (renderer->texture);
+  if (renderer->stage)
+    g_object_unref (renderer->stage);
+
+  g_slice_free (RBCLTOffscreenRenderer, renderer);
+}
+
+static VALUE
+rbclt_offscreen_renderer_alloc_with_class (VALUE klass)
+{
+  RBCLTOffscreenRenderer *renderer = g_slice_new0 (RBCLTOffscreenRenderer);
+
+  renderer->texture = COGL_INVALID_HANDLE;
+  renderer->offscreen = COGL_INVALID_HANDLE;
+
+  return Data_Wrap_Struct (klass, NULL, rbclt_offscreen_renderer_free,
+                           renderer);
+}
+
+static RBCLTOffscreenRenderer *
+rbclt_offscreen_renderer_get_pointer (VALUE self)
+{
+  RBCLTOffscreenRenderer *renderer;
+
+  Data_Get_Struct (self, RBCLTOffscreenRenderer, renderer);
+
+  if (renderer->offscreen == COGL_INVALID_HANDLE)
+    rb_raise (rb_eRuntimeError, "the renderer has not been initialized");
+
+  return renderer;
+}
+
+static VALUE
+rbclt_offscreen_renderer_initialize (int argc, VALUE *argv, VALUE self)
+{
+  RBCLTOffscreenRenderer *renderer;
+  VALUE width, height, stage;
+
+  rb_scan_args (argc, argv, "21", &width, &height, &stage);
+
+  Data_Get_Struct (self, RBCLTOffscreenRenderer, renderer);
+
+  if (renderer->offscreen != COGL_INVALID_HANDLE)
+    rb_raise (rb_eRuntimeError, "the renderer is already initialized");
+
+  renderer->width = NUM2UINT (width);
+  renderer->height = NUM2UINT (height);
+
+  if (renderer->width == 0 || renderer->height == 0)
+    rb_raise (rb_eArgError, "the size must be positive");
+
+  renderer->stage = CLUTTER_STAGE (NIL_P (stage)
+                                   ? clutter_stage_get_default ()
+                                   : RVAL2GOBJ (stage));
+  g_object_ref (renderer->stage);
+
+  renderer->texture
+    = cogl_texture_new_with_size (renderer->width, renderer->height,
+                                  COGL_TEXTURE_NO_SLICING,
+                                  COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+  if (renderer->texture == COGL_INVALID_HANDLE)
+    rb_raise (rb_eRuntimeError, "failed to create the texture");
+
+  renderer->offscreen = cogl_offscreen_new_to_texture (renderer->texture);
+  if (renderer->offscreen == COGL_INVALID_HANDLE)
+    rb_raise (rb_const_get (rb_const_get (rbclt_c_cogl,
+                                          rb_intern ("Offscreen")),
+                            rb_intern ("Error")),
+              "failed to create offscreen object");
+
+  return Qnil;
+}
+
+typedef struct _RenderData RenderData;
+
+struct _RenderData
+{
+  RBCLTOffscreenRenderer *renderer;
+  ClutterActor *actor;
+  gboolean fit;
+  /* Whether the actor was added to the renderer's stage */
+  gboolean adopted;
+  /* Whether the framebuffer and matrix have been pushed */
+  gboolean pushed;
+};
+
+static VALUE
+rbclt_offscreen_renderer_do_paint (VALUE arg)
+{
+  RenderData *data = (RenderData *) arg;
+  RBCLTOffscreenRenderer *renderer = data->renderer;
+  ClutterActor *actor = data->actor;
+  ClutterActorBox box;
+  CoglColor transparent;
+  gfloat box_width, box_height, scale;
+
+  /* Actors are only painted while they are mapped */
+  if (clutter_actor_get_parent (actor) == NULL
+      && !CLUTTER_IS_STAGE (actor))
+    {
+      clutter_container_add_actor (CLUTTER_CONTAINER (renderer->stage),
+                                   actor);
+      data->adopted = TRUE;
+      clutter_actor_allocate_preferred_size (actor, CLUTTER_ALLOCATION_NONE);
+    }
+
+  if (!CLUTTER_ACTOR_IS_MAPPED (actor))
+    {
+      if (data->adopted)
+        rb_raise (rb_eRuntimeError, "the actor must be visible and the "
+                  "renderer's stage must be shown");
+      else
+        rb_raise (rb_eArgError, "the actor must be mapped or have no parent");
+    }
+
+  clutter_actor_get_allocation_box (actor, &box);
+  clutter_actor_box_get_size (&box, &box_width, &box_height);
+
+  cogl_push_framebuffer (renderer->offscreen);
+  cogl_push_matrix ();
+  data->pushed = TRUE;
+
+  /* Map the framebuffer to the texture's pixels with the origin at
+     the top left like the stage */
+  cogl_ortho (0, renderer->width, renderer->height, 0, -1000, 1000);
+
+  cogl_color_set_from_4ub (&transparent, 0, 0, 0, 0);
+  cogl_clear (&transparent, COGL_BUFFER_BIT_COLOR | COGL_BUFFER_BIT_DEPTH);
+
+  if (data->fit && box_width > 0.0f && box_height > 0.0f)
+    {
+      scale = MIN (renderer->width / box_width,
+                   renderer->height / box_height);
+      cogl_scale (scale, scale, 1.0f);
+    }
+
+  /* Painting the actor applies its position within its parent so
+     that is undone to put it at the origin */
+  cogl_translate (-box.x1, -box.y1, 0.0f);
+  clutter_actor_paint (actor);
+
+  return Qnil;
+}
+
+static VALUE
+rbclt_offscreen_renderer_finish_paint (VALUE arg)
+{
+  RenderData *data = (RenderData *) arg;
+
+  /* This also runs if a paint handler raised an exception so that
+     the Cogl state and the stage are always restored */
+  if (data->pushed)
+    {
+      cogl_pop_matrix ();
+      cogl_pop_framebuffer ();
+    }
+
+  if (data->adopted)
+    clutter_container_remove_actor (CLUTTER_CONTAINER
+                                    (data->renderer->stage),
+                                    data->actor);
+
+  return Qnil;
+}
+
+static void
+rbclt_offscreen_renderer_render_actor (RBCLTOffscreenRenderer *renderer,
+                                       ClutterActor *actor, gboolean fit,
+                                       guchar *pixels)
+{
+  RenderData data;
+
+  data.renderer = renderer;
+  data.actor = actor;
+  data.fit = fit;
+  data.adopted = FALSE;
+  data.pushed = FALSE;
+
+  rb_ensure (rbclt_offscreen_renderer_do_paint, (VALUE) &data,
+             rbclt_offscreen_renderer_finish_paint, (VALUE) &data);
+
+  /* The texture stores premultiplied colors but the pixels are
+     returned unpremultiplied like Stage#read_pixels */
+  cogl_texture_get_data (renderer->texture, COGL_PIXEL_FORMAT_RGBA_8888,
+                         renderer->width * 4, pixels);
+}
+
+static VALUE
+rbclt_offscreen_renderer_render (int argc, VALUE *argv, VALUE self)
+{
+  RBCLTOffscreenRenderer *renderer
+    = rbclt_offscreen_renderer_get_pointer (self);
+  VALUE actor, fit, pixels;
+
+  rb_scan_args (argc, argv, "11", &actor, &fit);
+
+  pixels = rb_str_new (NULL, renderer->width * renderer->height * 4);
+
+  rbclt_offscreen_renderer_render_actor (renderer,
+                                         CLUTTER_ACTOR (RVAL2GOBJ (actor)),
+                                         RTEST (fit),
+                                         (guchar *) RSTRING_PTR (pixels));
+
+  return pixels;
+}
+
+static VALUE
+rbclt_offscreen_renderer_render_all (int argc, VALUE *argv, VALUE self)
+{
+  RBCLTOffscreenRenderer *renderer
+    = rbclt_offscreen_renderer_get_pointer (self);
+  long size = renderer->width * renderer->height * 4;
+  VALUE actors, fit, pixels = Qnil, ret = Qnil;
+  long i;
+
+  rb_scan_args (argc, argv, "11", &actors, &fit);
+
+  actors = rb_convert_type (actors, T_ARRAY, "Array", "to_ary");
+
+  /* With a block the same string is reused for every job. Without
+     one an array of separate strings is returned */
+  if (rb_block_given_p ())
+    pixels = rb_str_new (NULL, size);
+  else
+    ret = rb_ary_new2 (RARRAY_LEN (actors));
+
+  for (i = 0; i < RARRAY_LEN (actors); i++)
+    {
+      VALUE actor = RARRAY_PTR (actors)[i];
+
+      if (NIL_P (ret))
+        {
+          /* The block may have modified the string */
+          rb_str_modify (pixels);
+          if (RSTRING_LEN (pixels) != size)
+            rb_str_resize (pixels, size);
+        }
+      else
+        pixels = rb_str_new (NULL, size);
+
+      rbclt_offscreen_renderer_render_actor (renderer,
+                                             CLUTTER_ACTOR (RVAL2GOBJ (actor)),
+                                             RTEST (fit),
+                                             (guchar *) RSTRING_PTR (pixels));
+
+      if (NIL_P (ret))
+        rb_yield_values (2, actor, pixels);
+      else
+        rb_ary_push (ret, pixels);
+    }
+
+  return NIL_P (ret) ? self : ret;
+}
+
+static VALUE
+rbclt_offscreen_renderer_get_texture (VALUE self)
+{
+  RBCLTOffscreenRenderer *renderer
+    = rbclt_offscreen_renderer_get_pointer (self);
+
+  return rb_cogl_handle_to_value (renderer->texture);
+}
+
+static VALUE
+rbclt_offscreen_renderer_get_width (VALUE self)
+{
+  RBCLTOffscreenRenderer *renderer
+    = rbclt_offscreen_renderer_get_pointer (self);
+
+  return UINT2NUM (renderer->width);
+}
+
+static VALUE
+rbclt_offscreen_renderer_get_height (VALUE self)
+{
+  RBCLTOffscreenRenderer *renderer
+    = rbclt_offscreen_renderer_get_pointer (self);
+
+  return UINT2NUM (renderer->height);
+}
+
+void
+rbclt_offscreen_renderer_init ()
+{
+  VALUE klass = rb_define_class_under (rbclt_c_clutter, "OffscreenRenderer",
+                                       rb_cObject);
+
+  rb_define_alloc_func (klass, rbclt_offscreen_renderer_alloc_with_class);
+
+  rb_define_method (klass, "initialize",
+                    rbclt_offscreen_renderer_initialize, -1);
+  rb_define_method (klass, "render", rbclt_offscreen_renderer_render, -1);
+  rb_define_method (klass, "render_all",
+                    rbclt_offscreen_renderer_render_all, -1);
+  rb_define_method (klass, "texture", rbclt_offscreen_renderer_get_texture, 0);
+  rb_define_method (klass, "width", rbclt_offscreen_renderer_get_width, 0);
+  rb_define_method (klass, "height", rbclt_offscreen_renderer_get_height, 0);
+}
@@ -0,0 +1,464 @@
+/* Ruby bindings for the Clutter 'interactive canvas' library.
+ * Copyright (C) 2010  Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#include <clutter/clutter.h>
+#include <math.h>
+
+#include "rbcltspatialindex.h"
+
+typedef struct _RBCLTSpatialIndexEntry RBCLTSpatialIndexEntry;
+typedef struct _RBCLTSpatialIndexOrderData RBCLTSpatialIndexOrderData;
+
+struct _RBCLTSpatialIndexEntry
+{
+  ClutterActor *actor;
+  gfloat x1, y1, x2, y2;
+  /* The last rectangle query that returned this entry so that actors
+     spanning several cells are only returned once */
+  guint query;
+};
+
+struct _RBCLTSpatialIndex
+{
+  ClutterStage *stage;
+  gfloat cell_size;
+
+  /* Incremented whenever anything happens that could move an actor
+     on the stage. The grid is rebuilt when this doesn't match the
+     generation it was built for */
+  guint generation;
+  guint built_generation;
+  guint query;
+
+  /* Entries in painting order */
+  GArray *entries;
+
+  guint n_columns, n_rows;
+  /* An array of entry indices for each cell or NULL if the cell is
+     empty */
+  GArray **cells;
+};
+
+struct _RBCLTSpatialIndexOrderData
+{
+  RBCLTSpatialIndex *index;
+  guint pos;
+  gboolean matches;
+};
+
+/* Maps each stage to its index so that the hooks only invalidate the
+   index for the stage that changed */
+static GHashTable *rbclt_spatial_index_stages = NULL;
+
+/* The names of the properties that move an actor or change whether
+   it is picked. These are interned so that they can be compared with
+   the interned names of the notified properties by pointer */
+static const gchar *rbclt_spatial_index_transform_props[] =
+  {
+    "mapped", "reactive", "scale-x", "scale-y", "rotation-angle-x",
+    "rotation-angle-y", "rotation-angle-z", "anchor-x", "anchor-y", "depth"
+  };
+
+static void
+rbclt_spatial_index_invalidate_actor (ClutterActor *actor)
+{
+  RBCLTSpatialIndex *index;
+  ClutterActor *stage;
+
+  if (actor == NULL
+      || g_hash_table_size (rbclt_spatial_index_stages) == 0
+      || (stage = clutter_actor_get_stage (actor)) == NULL)
+    return;
+
+  if ((index = g_hash_table_lookup (rbclt_spatial_index_stages, stage)))
+    index->generation++;
+}
+
+static gboolean
+rbclt_spatial_index_invalidate_hook (GSignalInvocationHint *ihint,
+                                     guint n_param_values,
+                                     const GValue *param_values,
+                                     gpointer data)
+{
+  rbclt_spatial_index_invalidate_actor (g_value_get_object (param_values));
+
+  return TRUE;
+}
+
+static gboolean
+rbclt_spatial_index_parent_set_hook (GSignalInvocationHint *ihint,
+                                     guint n_param_values,
+                                     const GValue *param_values,
+                                     gpointer data)
+{
+  /* An actor that was removed is no longer on the stage so the index
+     is found from the old parent instead */
+  rbclt_spatial_index_invalidate_actor (g_value_get_object (param_values));
+  rbclt_spatial_index_invalidate_actor (g_value_get_object (param_values
+                                                            + 1));
+
+  return TRUE;
+}
+
+static gboolean
+rbclt_spatial_index_notify_hook (GSignalInvocationHint *ihint,
+                                 guint n_param_values,
+                                 const GValue *param_values,
+                                 gpointer data)
+{
+  GParamSpec *pspec = g_value_get_param (param_values + 1);
+  int i;
+
+  for (i = 0; i < G_N_ELEMENTS (rbclt_spatial_index_transform_props); i++)
+    if (pspec->name == rbclt_spatial_index_transform_props[i])
+      {
+        gpointer object = g_value_get_object (param_values);
+
+        if (CLUTTER_IS_ACTOR (object))
+          rbclt_spatial_index_invalidate_actor (object);
+        break;
+      }
+
+  return TRUE;
+}
+
+static void
+rbclt_spatial_index_install_hooks (void)
+{
+  guint signal_id;
+  int i;
+
+  if (rbclt_spatial_index_stages)
+    return;
+
+  rbclt_spatial_index_stages = g_hash_table_new (NULL, NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (rbclt_spatial_index_transform_props); i++)
+    rbclt_spatial_index_transform_props[i]
+      = g_intern_static_string (rbclt_spatial_index_transform_props[i]);
+
+  /* The class is never unreferenced so that the hooks stay valid */
+  g_type_class_ref (CLUTTER_TYPE_ACTOR);
+
+  signal_id = g_signal_lookup ("allocation-changed", CLUTTER_TYPE_ACTOR);
+  g_signal_add_emission_hook (signal_id, 0,
+                              rbclt_spatial_index_invalidate_hook,
+                              NULL, NULL);
+  signal_id = g_signal_lookup ("parent-set", CLUTTER_TYPE_ACTOR);
+  g_signal_add_emission_hook (signal_id, 0,
+                              rbclt_spatial_index_parent_set_hook,
+                              NULL, NULL);
+  signal_id = g_signal_lookup ("notify", G_TYPE_OBJECT);
+  g_signal_add_emission_hook (signal_id, 0,
+                              rbclt_spatial_index_notify_hook,
+                              NULL, NULL);
+}
+
+RBCLTSpatialIndex *
+rbclt_spatial_index_new (ClutterStage *stage, gfloat cell_size)
+{
+  RBCLTSpatialIndex *index = g_slice_new0 (RBCLTSpatialIndex);
+
+  rbclt_spatial_index_install_hooks ();
+
+  index->stage = stage;
+  index->cell_size = cell_size;
+  index->generation = 1;
+  index->entries = g_array_new (FALSE, FALSE,
+                                sizeof (RBCLTSpatialIndexEntry));
+
+  g_hash_table_insert (rbclt_spatial_index_stages, stage, index);
+
+  return index;
+}
+
+static void
+rbclt_spatial_index_clear (RBCLTSpatialIndex *index)
+{
+  guint i;
+
+  for (i = 0; i < index->n_columns * index->n_rows; i++)
+    if (index->cells[i])
+      g_array_free (index->cells[i], TRUE);
+
+  g_free (index->cells);
+  index->cells = NULL;
+  index->n_columns = index->n_rows = 0;
+
+  g_array_set_size (index->entries, 0);
+}
+
+void
+rbclt_spatial_index_free (RBCLTSpatialIndex *index)
+{
+  /* A new index for the same stage may already have replaced this one */
+  if (g_hash_table_lookup (rbclt_spatial_index_stages, index->stage) == index)
+    g_hash_table_remove (rbclt_spatial_index_stages, index->stage);
+
+  rbclt_spatial_index_clear (index);
+  g_array_free (index->entries, TRUE);
+  g_slice_free (RBCLTSpatialIndex, index);
+}
+
+static void
+rbclt_spatial_index_collect (ClutterActor *actor, gpointer data)
+{
+  RBCLTSpatialIndex *index = data;
+
+  if (!CLUTTER_ACTOR_IS_MAPPED (actor))
+    return;
+
+  if (CLUTTER_ACTOR_IS_REACTIVE (actor))
+    {
+      RBCLTSpatialIndexEntry entry;
+      ClutterVertex verts[4];
+      int i;
+
+      clutter_actor_get_abs_allocation_vertices (actor, verts);
+
+      entry.actor = actor;
+      entry.x1 = entry.x2 = verts[0].x;
+      entry.y1 = entry.y2 = verts[0].y;
+      entry.query = 0;
+
+      for (i = 1; i < 4; i++)
+        {
+          entry.x1 = MIN (entry.x1, verts[i].x);
+          entry.y1 = MIN (entry.y1, verts[i].y);
+          entry.x2 = MAX (entry.x2, verts[i].x);
+          entry.y2 = MAX (entry.y2, verts[i].y);
+        }
+
+      g_array_append_val (index->entries, entry);
+    }
+
+  /* Children are visited after their parent and in list order so that
+     the entries end up in the order they are painted */
+  if (CLUTTER_IS_CONTAINER (actor))
+    clutter_container_foreach (CLUTTER_CONTAINER (actor),
+                               rbclt_spatial_index_collect, index);
+}
+
+static void
+rbclt_spatial_index_check_order_callback (ClutterActor *actor, gpointer data)
+{
+  RBCLTSpatialIndexOrderData *order_data = data;
+  GArray *entries = order_data->index->entries;
+
+  if (!order_data->matches || !CLUTTER_ACTOR_IS_MAPPED (actor))
+    return;
+
+  if (CLUTTER_ACTOR_IS_REACTIVE (actor))
+    {
+      if (order_data->pos >= entries->len
+          || g_array_index (entries, RBCLTSpatialIndexEntry,
+                            order_data->pos).actor != actor)
+        {
+          order_data->matches = FALSE;
+          return;
+        }
+
+      order_data->pos++;
+    }
+
+  if (CLUTTER_IS_CONTAINER (actor))
+    clutter_container_foreach (CLUTTER_CONTAINER (actor),
+                               rbclt_spatial_index_check_order_callback,
+                               order_data);
+}
+
+/* Raising or lowering a child doesn't emit any signal that the hooks
+   could catch so the painting order of the entries is checked on
+   each query instead. This is only a walk over the actor pointers so
+   it is much cheaper than rebuilding the grid */
+static gboolean
+rbclt_spatial_index_check_order (RBCLTSpatialIndex *index)
+{
+  RBCLTSpatialIndexOrderData order_data;
+
+  order_data.index = index;
+  order_data.pos = 0;
+  order_data.matches = TRUE;
+
+  clutter_container_foreach (CLUTTER_CONTAINER (index->stage),
+                             rbclt_spatial_index_check_order_callback,
+                             &order_data);
+
+  return order_data.matches && order_data.pos == index->entries->len;
+}
+
+static void
+rbclt_spatial_index_cell_range (RBCLTSpatialIndex *index,
+                                gfloat x1, gfloat y1, gfloat x2, gfloat y2,
+                                guint *c1, guint *r1, guint *c2, guint *r2)
+{
+  /* Anything off the edges of the stage goes in the edge cells */
+  *c1 = CLAMP (floorf (x1 / index->cell_size), 0, index->n_columns - 1);
+  *r1 = CLAMP (floorf (y1 / index->cell_size), 0, index->n_rows - 1);
+  *c2 = CLAMP (floorf (x2 / index->cell_size), 0, index->n_columns - 1);
+  *r2 = CLAMP (floorf (y2 / index->cell_size), 0, index->n_rows - 1);
+}
+
+static void
+rbclt_spatial_index_ensure (RBCLTSpatialIndex *index)
+{
+  guint generation = index->generation;
+  gfloat width, height;
+  guint i, c, r, c1, r1, c2, r2;
+
+  if (index->built_generation == generation
+      && rbclt_spatial_index_check_order (index))
+    return;
+
+  rbclt_spatial_index_clear (index);
+
+  clutter_actor_get_size (CLUTTER_ACTOR (index->stage), &width, &height);
+  index->n_columns = MAX (ceilf (width / index->cell_size), 1);
+  index->n_rows = MAX (ceilf (height / index->cell_size), 1);
+  index->cells = g_new0 (GArray *, index->n_columns * index->n_rows);
+
+  clutter_container_foreach (CLUTTER_CONTAINER (index->stage),
+                             rbclt_spatial_index_collect, index);
+
+  for (i = 0; i < index->entries->len; i++)
+    {
+      RBCLTSpatialIndexEntry *entry
+        = &g_array_index (index->entries, RBCLTSpatialIndexEntry, i);
+
+      rbclt_spatial_index_cell_range (index,
+                                      entry->x1, entry->y1,
+                                      entry->x2, entry->y2,
+                                      &c1, &r1, &c2, &r2);
+
+      for (r = r1; r <= r2; r++)
+        for (c = c1; c <= c2; c++)
+          {
+            GArray **cell = index->cells + r * index->n_columns + c;
+
+            if (*cell == NULL)
+              *cell = g_array_new (FALSE, FALSE, sizeof (guint));
+
+            g_array_append_val (*cell, i);
+          }
+    }
+
+  /* Collecting the vertices may cause a relayout. In that case the
+     generation will have changed and the grid gets rebuilt again on
+     the next query */
+  index->built_generation = generation;
+}
+
+ClutterActor *
+rbclt_spatial_index_actor_at_pos (RBCLTSpatialIndex *index,
+                                  gfloat x, gfloat y)
+{
+  GArray *cell;
+  guint c, r;
+  gint i;
+
+  rbclt_spatial_index_ensure (index);
+
+  rbclt_spatial_index_cell_range (index, x, y, x, y, &c, &r, &c, &r);
+  cell = index->cells[r * index->n_columns + c];
+
+  /* The cell lists the entries in painting order so the topmost actor
+     is the last one that matches */
+  if (cell)
+    for (i = cell->len - 1; i >= 0; i--)
+      {
+        RBCLTSpatialIndexEntry *entry
+          = &g_array_index (index->entries, RBCLTSpatialIndexEntry,
+                            g_array_index (cell, guint, i));
+
+        if (x >= entry->x1 && x < entry->x2
+            && y >= entry->y1 && y < entry->y2)
+          return entry->actor;
+      }
+
+  return CLUTTER_ACTOR (index->stage);
+}
+
+static gint
+rbclt_spatial_index_compare_entries (gconstpointer a, gconstpointer b)
+{
+  guint ia = *(const guint *) a, ib = *(const guint *) b;
+
+  return ia < ib ? -1 : ia > ib ? 1 : 0;
+}
+
+GPtrArray *
+rbclt_spatial_index_actors_in_rect (RBCLTSpatialIndex *index,
+                                    gfloat x, gfloat y,
+                                    gfloat width, gfloat height)
+{
+  GArray *matches = g_array_new (FALSE, FALSE, sizeof (guint));
+  GPtrArray *actors;
+  guint i, c, r, c1, r1, c2, r2;
+
+  rbclt_spatial_index_ensure (index);
+
+  if (++index->query == 0)
+    {
+      /* Reset the stamps when the counter wraps */
+      for (i = 0; i < index->entries->len; i++)
+        g_array_index (index->entries, RBCLTSpatialIndexEntry, i).query = 0;
+      index->query = 1;
+    }
+
+  rbclt_spatial_index_cell_range (index, x, y, x + width, y + height,
+                                  &c1, &r1, &c2, &r2);
+
+  for (r = r1; r <= r2; r++)
+    for (c = c1; c <= c2; c++)
+      {
+        GArray *cell = index->cells[r * index->n_columns + c];
+
+        if (cell == NULL)
+          continue;
+
+        for (i = 0; i < cell->len; i++)
+          {
+            guint entry_num = g_array_index (cell, guint, i);
+            RBCLTSpatialIndexEntry *entry
+              = &g_array_index (index->entries, RBCLTSpatialIndexEntry,
+                                entry_num);
+
+            if (entry->query != index->query
+                && entry->x1 < x + width && entry->x2 > x
+                && entry->y1 < y + height && entry->y2 > y)
+              {
+                entry->query = index->query;
+                g_array_append_val (matches, entry_num);
+              }
+          }
+      }
+
+  g_array_sort (matches, rbclt_spatial_index_compare_entries);
+
+  actors = g_ptr_array_sized_new (matches->len);
+  for (i = 0; i < matches->len; i++)
+    g_ptr_array_add (actors,
+                     g_array_index (index->entries, RBCLTSpatialIndexEntry,
+                                    g_array_index (matches, guint,
+                                                   i)).actor);
+
+  g_array_free (matches, TRUE);
+
+  return actors;
+}
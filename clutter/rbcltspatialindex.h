@@ -0,0 +1,46 @@
+/* Ruby bindings for the Clutter 'interactive canvas' library.
+ * Copyright (C) 2010  Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#ifndef _RBCLT_SPATIAL_INDEX_H
+#define _RBCLT_SPATIAL_INDEX_H
+
+#include <clutter/clutter.h>
+
+typedef struct _RBCLTSpatialIndex RBCLTSpatialIndex;
+
+/* A grid of the transformed bounding boxes of the reactive actors on
+   a stage. The grid is rebuilt lazily the next time it is queried
+   after any actor on its stage has been reallocated, reparented,
+   transformed or restacked so that repeated queries on a static scene
+   don't need a pick render */
+RBCLTSpatialIndex *rbclt_spatial_index_new (ClutterStage *stage,
+                                            gfloat cell_size);
+void rbclt_spatial_index_free (RBCLTSpatialIndex *index);
+
+/* Returns the topmost reactive actor whose bounding box contains the
+   point or the stage if there isn't one */
+ClutterActor *rbclt_spatial_index_actor_at_pos (RBCLTSpatialIndex *index,
+                                                gfloat x, gfloat y);
+/* Returns an array of the reactive actors whose bounding boxes
+   intersect the rectangle in painting order */
+GPtrArray *rbclt_spatial_index_actors_in_rect (RBCLTSpatialIndex *index,
+                                               gfloat x, gfloat y,
+                                               gfloat width, gfloat height);
+
+#endif /* _RBCLT_SPATIAL_INDEX_H */
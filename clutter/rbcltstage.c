@@ -21,6 +21,9 @@
 #include <clutter/clutter.h>
 
 #include "rbclutter.h"
+#include "rbcltspatialindex.h"
+
+static GQuark rbclt_stage_spatial_index_quark = 0;
 
 static VALUE
 rbclt_stage_initialize (VALUE self)
@@ -61,18 +64,104 @@ rbclt_stage_hide_cursor (VALUE self)
   return self;
 }
 
+static RBCLTSpatialIndex *
+rbclt_stage_get_spatial_index (ClutterStage *stage)
+{
+  return g_object_get_qdata (G_OBJECT (stage),
+                             rbclt_stage_spatial_index_quark);
+}
+
 static VALUE
 rbclt_stage_get_actor_at_pos (VALUE self, VALUE pick_mode, VALUE x, VALUE y)
 {
   ClutterStage *stage = CLUTTER_STAGE (RVAL2GOBJ (self));
   ClutterPickMode pick_mode_value = RVAL2GENUM (pick_mode,
                                                 CLUTTER_TYPE_PICK_MODE);
+  RBCLTSpatialIndex *index = rbclt_stage_get_spatial_index (stage);
+
+  /* The index only contains reactive actors so it can't answer the
+     other pick modes */
+  if (index && pick_mode_value == CLUTTER_PICK_REACTIVE)
+    return GOBJ2RVAL (rbclt_spatial_index_actor_at_pos (index,
+                                                        NUM2DBL (x),
+                                                        NUM2DBL (y)));
+
   return GOBJ2RVAL (clutter_stage_get_actor_at_pos (stage,
                                                     pick_mode_value,
                                                     NUM2INT (x),
                                                     NUM2INT (y)));
 }
 
+static VALUE
+rbclt_stage_enable_spatial_index (int argc, VALUE *argv, VALUE self)
+{
+  ClutterStage *stage = CLUTTER_STAGE (RVAL2GOBJ (self));
+  VALUE cell_size_arg;
+  gfloat cell_size;
+
+  rb_scan_args (argc, argv, "01", &cell_size_arg);
+
+  cell_size = NIL_P (cell_size_arg) ? 64.0f : NUM2DBL (cell_size_arg);
+  if (cell_size <= 0.0f)
+    rb_raise (rb_eArgError, "the cell size must be positive");
+
+  g_object_set_qdata_full (G_OBJECT (stage), rbclt_stage_spatial_index_quark,
+                           rbclt_spatial_index_new (stage, cell_size),
+                           (GDestroyNotify) rbclt_spatial_index_free);
+
+  return self;
+}
+
+static VALUE
+rbclt_stage_disable_spatial_index (VALUE self)
+{
+  ClutterStage *stage = CLUTTER_STAGE (RVAL2GOBJ (self));
+
+  g_object_set_qdata (G_OBJECT (stage), rbclt_stage_spatial_index_quark,
+                      NULL);
+
+  return self;
+}
+
+static VALUE
+rbclt_stage_is_spatial_index_enabled (VALUE self)
+{
+  ClutterStage *stage = CLUTTER_STAGE (RVAL2GOBJ (self));
+
+  return rbclt_stage_get_spatial_index (stage) ? Qtrue : Qfalse;
+}
+
+static VALUE
+rbclt_stage_actors_in_rect (VALUE self, VALUE x, VALUE y,
+                            VALUE width, VALUE height)
+{
+  ClutterStage *stage = CLUTTER_STAGE (RVAL2GOBJ (self));
+  RBCLTSpatialIndex *index = rbclt_stage_get_spatial_index (stage);
+  GPtrArray *actors;
+  VALUE ret;
+  guint i;
+
+  /* The index is created on demand with the default cell size */
+  if (index == NULL)
+    {
+      rbclt_stage_enable_spatial_index (0, NULL, self);
+      index = rbclt_stage_get_spatial_index (stage);
+    }
+
+  actors = rbclt_spatial_index_actors_in_rect (index,
+                                               NUM2DBL (x), NUM2DBL (y),
+                                               NUM2DBL (width),
+                                               NUM2DBL (height));
+
+  ret = rb_ary_new2 (actors->len);
+  for (i = 0; i < actors->len; i++)
+    rb_ary_push (ret, GOBJ2RVAL (g_ptr_array_index (actors, i)));
+
+  g_ptr_array_free (actors, TRUE);
+
+  return ret;
+}
+
 static VALUE
 rbclt_stage_event (VALUE self, VALUE event_arg)
 {
@@ -170,12 +259,22 @@ rbclt_stage_init ()
 {
   VALUE klass = G_DEF_CLASS (CLUTTER_TYPE_STAGE, "Stage", rbclt_c_clutter);
 
+  rbclt_stage_spatial_index_quark
+    = g_quark_from_static_string ("rbclt-stage-spatial-index");
+
   rb_define_singleton_method (klass, "get_default", rbclt_stage_get_default, 0);
 
   rb_define_method (klass, "initialize", rbclt_stage_initialize, 0);
   rb_define_method (klass, "show_cursor", rbclt_stage_show_cursor, 0);
   rb_define_method (klass, "hide_cursor", rbclt_stage_hide_cursor, 0);
   rb_define_method (klass, "get_actor_at_pos", rbclt_stage_get_actor_at_pos, 3);
+  rb_define_method (klass, "enable_spatial_index",
+                    rbclt_stage_enable_spatial_index, -1);
+  rb_define_method (klass, "disable_spatial_index",
+                    rbclt_stage_disable_spatial_index, 0);
+  rb_define_method (klass, "spatial_index_enabled?",
+                    rbclt_stage_is_spatial_index_enabled, 0);
+  rb_define_method (klass, "actors_in_rect", rbclt_stage_actors_in_rect, 4);
   rb_define_method (klass, "event", rbclt_stage_event, 1);
   rb_define_method (klass, "read_pixels", rbclt_stage_read_pixels, 4);
   rb_define_method (klass, "set_key_focus", rbclt_stage_set_key_focus, 1);
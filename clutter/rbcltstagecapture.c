@@ -0,0 +1,336 @@
+/* Ruby bindings for the Clutter 'interactive canvas' library.
+ * Copyright (C) 2010  Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#include <rbgobject.h>
+#include <clutter/clutter.h>
+
+#include "rbclutter.h"
+
+/* A stage capture reads back a region of the stage after each normal
+   paint and hands the pixels to a Ruby callback from an idle handler.
+   Stage#read_pixels has to paint the stage again and allocate a new
+   buffer for every call. Here the pixels are read straight into a
+   ring of preallocated strings so the callback can encode a frame
+   while the next one is being painted.
+
+   A buffer passed to the callback belongs to the callback until it
+   gives it back with StageCapture#release, so it can be kept while it
+   is encoded on another thread or across several main loop
+   iterations. Frames are dropped while every buffer is either waiting
+   to be delivered or held by the callback */
+
+typedef struct _RBCLTStageCapture RBCLTStageCapture;
+
+enum
+  {
+    RBCLT_STAGE_CAPTURE_BUFFER_FREE,
+    RBCLT_STAGE_CAPTURE_BUFFER_PENDING,
+    RBCLT_STAGE_CAPTURE_BUFFER_HELD
+  };
+
+struct _RBCLTStageCapture
+{
+  ClutterStage *stage;
+  gulong paint_handler;
+  gint x, y, width, height;
+
+  /* Array of strings that the pixels are read into */
+  VALUE buffers;
+  guint n_buffers;
+  /* The state of each buffer */
+  guint8 *buffer_states;
+  /* Indices of the buffers that have been filled but not yet passed
+     to the callback in the order they were filled. This is a ring
+     starting at first_pending */
+  guint *pending;
+  guint first_pending, n_pending;
+  guint n_dropped;
+
+  VALUE callback;
+  guint idle_source;
+};
+
+static void
+rbclt_stage_capture_mark (void *data)
+{
+  RBCLTStageCapture *capture = data;
+
+  rb_gc_mark (capture->buffers);
+  rb_gc_mark (capture->callback);
+}
+
+static void
+rbclt_stage_capture_stop_internal (RBCLTStageCapture *capture)
+{
+  if (capture->paint_handler)
+    {
+      g_signal_handler_disconnect (capture->stage, capture->paint_handler);
+      capture->paint_handler = 0;
+    }
+  if (capture->idle_source)
+    {
+      g_source_remove (capture->idle_source);
+      capture->idle_source = 0;
+    }
+
+  /* Frames that haven't been delivered yet are discarded. Buffers
+     that the callback holds stay with it until they are released */
+  for (; capture->n_pending > 0; capture->n_pending--)
+    {
+      capture->buffer_states[capture->pending[capture->first_pending]]
+        = RBCLT_STAGE_CAPTURE_BUFFER_FREE;
+      capture->first_pending
+        = (capture->first_pending + 1) % capture->n_buffers;
+    }
+}
+
+static void
+rbclt_stage_capture_free (void *data)
+{
+  RBCLTStageCapture *capture = data;
+
+  if (capture->stage)
+    {
+      rbclt_stage_capture_stop_internal (capture);
+      g_object_unref (capture->stage);
+    }
+
+  g_free (capture->buffer_states);
+  g_free (capture->pending);
+
+  g_slice_free (RBCLTStageCapture, capture);
+}
+
+static VALUE
+rbclt_stage_capture_alloc_with_class (VALUE klass)
+{
+  RBCLTStageCapture *capture = g_slice_new0 (RBCLTStageCapture);
+
+  capture->buffers = Qnil;
+  capture->callback = Qnil;
+
+  return Data_Wrap_Struct (klass, rbclt_stage_capture_mark,
+                           rbclt_stage_capture_free, capture);
+}
+
+static RBCLTStageCapture *
+rbclt_stage_capture_get_pointer (VALUE self)
+{
+  RBCLTStageCapture *capture;
+
+  Data_Get_Struct (self, RBCLTStageCapture, capture);
+
+  return capture;
+}
+
+static gboolean
+rbclt_stage_capture_deliver (gpointer data)
+{
+  RBCLTStageCapture *capture = data;
+
+  capture->idle_source = 0;
+
+  while (capture->n_pending > 0)
+    {
+      guint slot = capture->pending[capture->first_pending];
+
+      /* The buffer is handed over before calling Ruby so that the
+         capture stays consistent if the callback raises */
+      capture->first_pending
+        = (capture->first_pending + 1) % capture->n_buffers;
+      capture->n_pending--;
+      capture->buffer_states[slot] = RBCLT_STAGE_CAPTURE_BUFFER_HELD;
+
+      rb_funcall (capture->callback, rb_intern ("call"), 1,
+                  RARRAY_PTR (capture->buffers)[slot]);
+    }
+
+  return FALSE;
+}
+
+static void
+rbclt_stage_capture_on_paint (ClutterActor *stage,
+                              RBCLTStageCapture *capture)
+{
+  guint slot;
+
+  /* If the callback hasn't released any buffers then the frame is
+     dropped rather than overwriting one that it might still be
+     reading */
+  for (slot = 0; slot < capture->n_buffers; slot++)
+    if (capture->buffer_states[slot] == RBCLT_STAGE_CAPTURE_BUFFER_FREE)
+      break;
+
+  if (slot >= capture->n_buffers)
+    {
+      capture->n_dropped++;
+      return;
+    }
+
+  /* The stage has just finished painting so the back buffer holds the
+     new frame. Free buffers always have the right size because
+     release checks them so nothing here can raise */
+  cogl_read_pixels (capture->x, capture->y, capture->width, capture->height,
+                    COGL_READ_PIXELS_COLOR_BUFFER,
+                    COGL_PIXEL_FORMAT_RGBA_8888,
+                    (guchar *) RSTRING_PTR (RARRAY_PTR (capture->buffers)
+                                            [slot]));
+
+  capture->buffer_states[slot] = RBCLT_STAGE_CAPTURE_BUFFER_PENDING;
+  capture->pending[(capture->first_pending + capture->n_pending)
+                   % capture->n_buffers] = slot;
+  capture->n_pending++;
+
+  /* The callback isn't invoked from within the paint */
+  if (capture->idle_source == 0)
+    capture->idle_source
+      = clutter_threads_add_idle (rbclt_stage_capture_deliver, capture);
+}
+
+static VALUE
+rbclt_stage_capture_initialize (int argc, VALUE *argv, VALUE self)
+{
+  RBCLTStageCapture *capture = rbclt_stage_capture_get_pointer (self);
+  VALUE stage, x, y, width, height, n_buffers_arg, callback;
+  long n_buffers, i;
+
+  rb_scan_args (argc, argv, "51&", &stage, &x, &y, &width, &height,
+                &n_buffers_arg, &callback);
+
+  if (NIL_P (callback))
+    rb_raise (rb_eArgError, "a block is required");
+
+  capture->x = NUM2INT (x);
+  capture->y = NUM2INT (y);
+  capture->width = NUM2INT (width);
+  capture->height = NUM2INT (height);
+  n_buffers = NIL_P (n_buffers_arg) ? 2 : NUM2INT (n_buffers_arg);
+
+  if (capture->width <= 0 || capture->height <= 0)
+    rb_raise (rb_eArgError, "the capture size must be positive");
+  if (n_buffers < 1)
+    rb_raise (rb_eArgError, "at least one buffer is required");
+
+  capture->buffers = rb_ary_new2 (n_buffers);
+  for (i = 0; i < n_buffers; i++)
+    rb_ary_push (capture->buffers,
+                 rb_str_new (NULL, capture->width * capture->height * 4));
+  capture->n_buffers = n_buffers;
+  capture->buffer_states = g_new0 (guint8, n_buffers);
+  capture->pending = g_new (guint, n_buffers);
+
+  capture->callback = callback;
+  capture->stage = g_object_ref (CLUTTER_STAGE (RVAL2GOBJ (stage)));
+
+  return Qnil;
+}
+
+static VALUE
+rbclt_stage_capture_start (VALUE self)
+{
+  RBCLTStageCapture *capture = rbclt_stage_capture_get_pointer (self);
+
+  if (capture->paint_handler == 0)
+    {
+      capture->paint_handler
+        = g_signal_connect_after (capture->stage, "paint",
+                                  G_CALLBACK (rbclt_stage_capture_on_paint),
+                                  capture);
+      clutter_actor_queue_redraw (CLUTTER_ACTOR (capture->stage));
+    }
+
+  return self;
+}
+
+static VALUE
+rbclt_stage_capture_stop (VALUE self)
+{
+  RBCLTStageCapture *capture = rbclt_stage_capture_get_pointer (self);
+
+  rbclt_stage_capture_stop_internal (capture);
+
+  return self;
+}
+
+static VALUE
+rbclt_stage_capture_release (VALUE self, VALUE buffer)
+{
+  RBCLTStageCapture *capture = rbclt_stage_capture_get_pointer (self);
+  long size = capture->width * capture->height * 4;
+  guint slot;
+
+  for (slot = 0; slot < capture->n_buffers; slot++)
+    if (RARRAY_PTR (capture->buffers)[slot] == buffer)
+      break;
+
+  if (slot >= capture->n_buffers
+      || capture->buffer_states[slot] != RBCLT_STAGE_CAPTURE_BUFFER_HELD)
+    rb_raise (rb_eArgError, "the buffer is not held by the callback");
+
+  /* The callback may have modified the string. This raises if it was
+     frozen, in which case the buffer stays held */
+  rb_str_modify (buffer);
+  if (RSTRING_LEN (buffer) != size)
+    rb_str_resize (buffer, size);
+
+  capture->buffer_states[slot] = RBCLT_STAGE_CAPTURE_BUFFER_FREE;
+
+  return self;
+}
+
+static VALUE
+rbclt_stage_capture_is_running (VALUE self)
+{
+  RBCLTStageCapture *capture = rbclt_stage_capture_get_pointer (self);
+
+  return capture->paint_handler ? Qtrue : Qfalse;
+}
+
+static VALUE
+rbclt_stage_capture_get_n_dropped (VALUE self)
+{
+  RBCLTStageCapture *capture = rbclt_stage_capture_get_pointer (self);
+
+  return UINT2NUM (capture->n_dropped);
+}
+
+static VALUE
+rbclt_stage_capture_get_stage (VALUE self)
+{
+  RBCLTStageCapture *capture = rbclt_stage_capture_get_pointer (self);
+
+  return GOBJ2RVAL (capture->stage);
+}
+
+void
+rbclt_stage_capture_init ()
+{
+  VALUE klass = rb_define_class_under (rbclt_c_clutter, "StageCapture",
+                                       rb_cObject);
+
+  rb_define_alloc_func (klass, rbclt_stage_capture_alloc_with_class);
+
+  rb_define_method (klass, "initialize", rbclt_stage_capture_initialize, -1);
+  rb_define_method (klass, "start", rbclt_stage_capture_start, 0);
+  rb_define_method (klass, "stop", rbclt_stage_capture_stop, 0);
+  rb_define_method (klass, "release", rbclt_stage_capture_release, 1);
+  rb_define_method (klass, "running?", rbclt_stage_capture_is_running, 0);
+  rb_define_method (klass, "n_dropped", rbclt_stage_capture_get_n_dropped, 0);
+  rb_define_method (klass, "stage", rbclt_stage_capture_get_stage, 0);
+}
@@ -0,0 +1,628 @@
+/* Ruby bindings for the Clutter 'interactive canvas' library.
+ * Copyright (C) 2010  Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#include <rbgobject.h>
+#include <clutter/clutter.h>
+
+#include "rbclutter.h"
+#include "rbcltstats.h"
+
+/* Frame times are collected into buckets where bucket n counts the
+   frames that spent between 2^n and 2^(n+1) microseconds in a
+   category. The last bucket also holds anything longer */
+#define N_BUCKETS 24
+
+typedef struct _RBCLTStatsData RBCLTStatsData;
+
+struct _RBCLTStatsData
+{
+  /* Time accumulated in the frame that is currently in progress */
+  gdouble frame_time;
+  guint frame_calls;
+
+  guint calls;
+  guint frames;
+  gdouble total;
+  gdouble max;
+  guint buckets[N_BUCKETS];
+};
+
+static const char *rbclt_stats_names[RBCLT_STATS_N_CATEGORIES] =
+  {
+    "paint",
+    "layout",
+    "pick",
+    "event",
+    "timeline",
+    "alpha",
+    "frame_source"
+  };
+
+gboolean rbclt_stats_enabled = FALSE;
+
+static RBCLTStatsData rbclt_stats_data[RBCLT_STATS_N_CATEGORIES];
+static guint rbclt_stats_n_frames = 0;
+static GTimer *rbclt_stats_timer = NULL;
+static gboolean rbclt_stats_hooks_installed = FALSE;
+
+/* An event is timed from when the stage receives the captured-event
+   signal until the handler connected after the stage's event signal
+   runs. If a handler stops the emission before it reaches the stage
+   then the event is closed at the time of the last event signal that
+   was seen */
+static gdouble rbclt_stats_event_start = -1.0;
+static gdouble rbclt_stats_event_last = 0.0;
+static guint rbclt_stats_captured_event_signal = 0;
+
+/* Time at which the new-frame emission hook ran for the current
+   emission, or a negative value if there isn't one */
+static gdouble rbclt_stats_new_frame_start = -1.0;
+
+/* Paint and pick are timed from a handler connected to each stage to
+   one connected after the class handler. Handlers that were connected
+   to the stage before stats were first enabled are not counted */
+static gdouble rbclt_stats_paint_start = 0.0;
+static gdouble rbclt_stats_pick_start = 0.0;
+
+/* A frame is closed from an idle after a master clock tick that
+   painted a stage. That way all of the stages painted in one tick
+   count as a single frame and paints done outside of the master
+   clock, such as for Stage#read_pixels, are added to the next frame
+   instead of starting a new one */
+static gboolean rbclt_stats_painted = FALSE;
+static guint rbclt_stats_end_frame_id = 0;
+
+/* The layout and timeline class handlers have no signal so they are
+   wrapped by replacing the function in the class structure. Each
+   table maps a class that was patched to the function it had before.
+   Classes are patched when an instance is first seen so subclasses
+   that were initialized before stats were enabled are still covered.
+   A subclass initialized afterwards inherits the wrapper so the
+   original is found by walking up to the nearest patched class */
+static GHashTable *rbclt_stats_old_allocates = NULL;
+static GHashTable *rbclt_stats_old_new_frames = NULL;
+
+/* The class whose original handler is currently running. A subclass
+   handler that chains up to a patched parent calls the wrapper again
+   so the search continues from the parent of this class */
+static gpointer rbclt_stats_allocate_class = NULL;
+static gpointer rbclt_stats_new_frame_class = NULL;
+
+static gdouble
+rbclt_stats_now (void)
+{
+  return g_timer_elapsed (rbclt_stats_timer, NULL) * 1000000.0;
+}
+
+gdouble
+rbclt_stats_begin (void)
+{
+  return rbclt_stats_enabled ? rbclt_stats_now () : 0.0;
+}
+
+void
+rbclt_stats_end (RBCLTStatsCategory category, gdouble start)
+{
+  RBCLTStatsData *data;
+
+  if (!rbclt_stats_enabled)
+    return;
+
+  data = rbclt_stats_data + category;
+  data->frame_time += rbclt_stats_now () - start;
+  data->frame_calls++;
+}
+
+static void
+rbclt_stats_close_event (gdouble end)
+{
+  if (rbclt_stats_event_start >= 0.0)
+    {
+      rbclt_stats_end (RBCLT_STATS_EVENT, rbclt_stats_event_start
+                       + rbclt_stats_now () - end);
+      rbclt_stats_event_start = -1.0;
+    }
+}
+
+static void
+rbclt_stats_end_frame (void)
+{
+  int i;
+
+  rbclt_stats_close_event (rbclt_stats_event_last);
+
+  for (i = 0; i < RBCLT_STATS_N_CATEGORIES; i++)
+    {
+      RBCLTStatsData *data = rbclt_stats_data + i;
+      guint time = data->frame_time;
+      int bucket = 0;
+
+      while (time > 1 && bucket < N_BUCKETS - 1)
+        {
+          time >>= 1;
+          bucket++;
+        }
+
+      data->buckets[bucket]++;
+      data->frames++;
+      data->calls += data->frame_calls;
+      data->total += data->frame_time;
+      if (data->frame_time > data->max)
+        data->max = data->frame_time;
+
+      data->frame_time = 0.0;
+      data->frame_calls = 0;
+    }
+
+  rbclt_stats_n_frames++;
+}
+
+static gboolean
+rbclt_stats_end_frame_idle (gpointer data)
+{
+  rbclt_stats_end_frame_id = 0;
+
+  if (rbclt_stats_enabled && rbclt_stats_painted)
+    rbclt_stats_end_frame ();
+
+  rbclt_stats_painted = FALSE;
+
+  return FALSE;
+}
+
+static gboolean
+rbclt_stats_repaint_func (gpointer data)
+{
+  /* Repaint functions are run by the master clock just before the
+     stages are updated so the idle runs once they are all painted */
+  if (rbclt_stats_enabled && rbclt_stats_end_frame_id == 0)
+    rbclt_stats_end_frame_id
+      = g_idle_add_full (G_PRIORITY_HIGH, rbclt_stats_end_frame_idle,
+                         NULL, NULL);
+
+  return TRUE;
+}
+
+/* Finds the nearest class at or above klass that was patched and
+   stores it in klass. Returns NULL if there isn't one */
+static gpointer
+rbclt_stats_find_old (GHashTable *table, gpointer *klass)
+{
+  gpointer old = NULL;
+
+  while (*klass && !g_hash_table_lookup_extended (table, *klass, NULL, &old))
+    *klass = g_type_class_peek_parent (*klass);
+
+  return *klass ? old : NULL;
+}
+
+static void
+rbclt_stats_patch_class (GHashTable *table, gpointer klass,
+                         gsize offset, gpointer func)
+{
+  gpointer *slot = G_STRUCT_MEMBER_P (klass, offset);
+
+  if (*slot != func)
+    {
+      g_hash_table_insert (table, klass, *slot);
+      *slot = func;
+    }
+}
+
+static void
+rbclt_stats_paint_before (ClutterActor *actor, gpointer data)
+{
+  rbclt_stats_paint_start = rbclt_stats_begin ();
+}
+
+static void
+rbclt_stats_paint_after (ClutterActor *actor, gpointer data)
+{
+  if (rbclt_stats_enabled)
+    {
+      rbclt_stats_end (RBCLT_STATS_PAINT, rbclt_stats_paint_start);
+      rbclt_stats_painted = TRUE;
+    }
+}
+
+static void
+rbclt_stats_pick_before (ClutterActor *actor, const ClutterColor *color,
+                         gpointer data)
+{
+  rbclt_stats_pick_start = rbclt_stats_begin ();
+}
+
+static void
+rbclt_stats_pick_after (ClutterActor *actor, const ClutterColor *color,
+                        gpointer data)
+{
+  rbclt_stats_end (RBCLT_STATS_PICK, rbclt_stats_pick_start);
+}
+
+static gboolean
+rbclt_stats_event_after (ClutterActor *actor, ClutterEvent *event,
+                         gpointer data)
+{
+  if (rbclt_stats_enabled)
+    rbclt_stats_close_event (rbclt_stats_now ());
+
+  return FALSE;
+}
+
+static void
+rbclt_stats_allocate (ClutterActor *actor,
+                      const ClutterActorBox *box,
+                      ClutterAllocationFlags flags)
+{
+  void (* old_allocate) (ClutterActor *actor,
+                         const ClutterActorBox *box,
+                         ClutterAllocationFlags flags);
+  gpointer old_class = rbclt_stats_allocate_class, klass;
+  gdouble start = 0.0;
+
+  if (old_class)
+    klass = g_type_class_peek_parent (old_class);
+  else
+    {
+      klass = G_OBJECT_GET_CLASS (actor);
+      start = rbclt_stats_begin ();
+    }
+
+  old_allocate = rbclt_stats_find_old (rbclt_stats_old_allocates, &klass);
+
+  /* This should never happen because the wrapper is only installed
+     in classes that are in the table */
+  if (old_allocate == NULL)
+    {
+      g_warning ("No original allocate function found for %s",
+                 G_OBJECT_TYPE_NAME (actor));
+      return;
+    }
+
+  rbclt_stats_allocate_class = klass;
+  (* old_allocate) (actor, box, flags);
+  rbclt_stats_allocate_class = old_class;
+
+  /* Only the outermost call is timed */
+  if (old_class == NULL)
+    rbclt_stats_end (RBCLT_STATS_LAYOUT, start);
+}
+
+static void
+rbclt_stats_new_frame (ClutterTimeline *timeline, gint msecs)
+{
+  void (* old_new_frame) (ClutterTimeline *timeline, gint msecs);
+  gpointer old_class = rbclt_stats_new_frame_class, klass;
+
+  klass = old_class ? g_type_class_peek_parent (old_class)
+    : G_OBJECT_GET_CLASS (timeline);
+  old_new_frame = rbclt_stats_find_old (rbclt_stats_old_new_frames, &klass);
+
+  rbclt_stats_new_frame_class = klass;
+  if (old_new_frame)
+    (* old_new_frame) (timeline, msecs);
+  rbclt_stats_new_frame_class = old_class;
+
+  /* The emission hook runs before any handlers and the class handler
+     runs after the normal handlers so the time in between is the
+     time spent in the handlers connected to new-frame */
+  if (rbclt_stats_new_frame_start >= 0.0)
+    {
+      rbclt_stats_end (RBCLT_STATS_TIMELINE, rbclt_stats_new_frame_start);
+      rbclt_stats_new_frame_start = -1.0;
+    }
+}
+
+static gboolean
+rbclt_stats_event_hook (GSignalInvocationHint *ihint,
+                        guint n_param_values,
+                        const GValue *param_values,
+                        gpointer data)
+{
+  if (rbclt_stats_enabled)
+    {
+      gdouble now = rbclt_stats_now ();
+
+      /* The stage is always the first actor to get the captured
+         event so that marks the start of a new event */
+      if (ihint->signal_id == rbclt_stats_captured_event_signal
+          && CLUTTER_IS_STAGE (g_value_get_object (param_values)))
+        {
+          rbclt_stats_close_event (rbclt_stats_event_last);
+          rbclt_stats_event_start = now;
+        }
+
+      rbclt_stats_event_last = now;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+rbclt_stats_new_frame_hook (GSignalInvocationHint *ihint,
+                            guint n_param_values,
+                            const GValue *param_values,
+                            gpointer data)
+{
+  if (rbclt_stats_enabled)
+    {
+      /* The class handler is looked up in the class structure when it
+         is invoked so patching it here still catches this emission */
+      rbclt_stats_patch_class (rbclt_stats_old_new_frames,
+                               G_OBJECT_GET_CLASS
+                               (g_value_get_object (param_values)),
+                               G_STRUCT_OFFSET (ClutterTimelineClass,
+                                                new_frame),
+                               rbclt_stats_new_frame);
+      rbclt_stats_new_frame_start = rbclt_stats_now ();
+    }
+
+  return TRUE;
+}
+
+static void
+rbclt_stats_watch_stage (ClutterStage *stage)
+{
+  rbclt_stats_patch_class (rbclt_stats_old_allocates,
+                           G_OBJECT_GET_CLASS (stage),
+                           G_STRUCT_OFFSET (ClutterActorClass, allocate),
+                           rbclt_stats_allocate);
+
+  g_signal_connect (stage, "paint",
+                    G_CALLBACK (rbclt_stats_paint_before), NULL);
+  g_signal_connect_after (stage, "paint",
+                          G_CALLBACK (rbclt_stats_paint_after), NULL);
+  g_signal_connect (stage, "pick",
+                    G_CALLBACK (rbclt_stats_pick_before), NULL);
+  g_signal_connect_after (stage, "pick",
+                          G_CALLBACK (rbclt_stats_pick_after), NULL);
+  g_signal_connect_after (stage, "event",
+                          G_CALLBACK (rbclt_stats_event_after), NULL);
+}
+
+static void
+rbclt_stats_stage_added (ClutterStageManager *manager,
+                         ClutterStage *stage,
+                         gpointer data)
+{
+  rbclt_stats_watch_stage (stage);
+}
+
+static void
+rbclt_stats_install_hooks (void)
+{
+  ClutterStageManager *manager;
+  GSList *stages, *l;
+  guint signal_id;
+
+  if (rbclt_stats_hooks_installed)
+    return;
+
+  rbclt_stats_timer = g_timer_new ();
+  rbclt_stats_old_allocates = g_hash_table_new (NULL, NULL);
+  rbclt_stats_old_new_frames = g_hash_table_new (NULL, NULL);
+
+  manager = clutter_stage_manager_get_default ();
+  stages = clutter_stage_manager_list_stages (manager);
+  for (l = stages; l; l = l->next)
+    rbclt_stats_watch_stage (l->data);
+  g_slist_free (stages);
+  g_signal_connect (manager, "stage-added",
+                    G_CALLBACK (rbclt_stats_stage_added), NULL);
+
+  clutter_threads_add_repaint_func (rbclt_stats_repaint_func, NULL, NULL);
+
+  rbclt_stats_captured_event_signal
+    = g_signal_lookup ("captured-event", CLUTTER_TYPE_ACTOR);
+  g_signal_add_emission_hook (rbclt_stats_captured_event_signal, 0,
+                              rbclt_stats_event_hook, NULL, NULL);
+  signal_id = g_signal_lookup ("event", CLUTTER_TYPE_ACTOR);
+  g_signal_add_emission_hook (signal_id, 0,
+                              rbclt_stats_event_hook, NULL, NULL);
+
+  /* Make sure the class exists so the signal can be found */
+  g_type_class_ref (CLUTTER_TYPE_TIMELINE);
+  signal_id = g_signal_lookup ("new-frame", CLUTTER_TYPE_TIMELINE);
+  g_signal_add_emission_hook (signal_id, 0,
+                              rbclt_stats_new_frame_hook, NULL, NULL);
+
+  rbclt_stats_hooks_installed = TRUE;
+}
+
+static VALUE
+rbclt_stats_enable (VALUE self)
+{
+  rbclt_stats_install_hooks ();
+  rbclt_stats_enabled = TRUE;
+
+  return self;
+}
+
+static VALUE
+rbclt_stats_disable (VALUE self)
+{
+  rbclt_stats_enabled = FALSE;
+
+  return self;
+}
+
+static VALUE
+rbclt_stats_is_enabled (VALUE self)
+{
+  return rbclt_stats_enabled ? Qtrue : Qfalse;
+}
+
+static VALUE
+rbclt_stats_reset (VALUE self)
+{
+  memset (rbclt_stats_data, 0, sizeof (rbclt_stats_data));
+  rbclt_stats_n_frames = 0;
+  rbclt_stats_event_start = -1.0;
+  rbclt_stats_new_frame_start = -1.0;
+  rbclt_stats_painted = FALSE;
+
+  return self;
+}
+
+static VALUE
+rbclt_stats_get_n_frames (VALUE self)
+{
+  return UINT2NUM (rbclt_stats_n_frames);
+}
+
+static VALUE
+rbclt_stats_get_categories (VALUE self)
+{
+  VALUE ret = rb_ary_new ();
+  int i;
+
+  for (i = 0; i < RBCLT_STATS_N_CATEGORIES; i++)
+    rb_ary_push (ret, ID2SYM (rb_intern (rbclt_stats_names[i])));
+
+  return ret;
+}
+
+static int
+rbclt_stats_lookup_category (VALUE category)
+{
+  const char *name;
+  int i;
+
+  if (SYMBOL_P (category))
+    name = rb_id2name (SYM2ID (category));
+  else
+    name = StringValuePtr (category);
+
+  for (i = 0; i < RBCLT_STATS_N_CATEGORIES; i++)
+    if (!strcmp (rbclt_stats_names[i], name))
+      return i;
+
+  rb_raise (rb_eArgError, "unknown stats category %s", name);
+
+  return 0;
+}
+
+static VALUE
+rbclt_stats_category_to_hash (const RBCLTStatsData *data)
+{
+  VALUE hash = rb_hash_new ();
+  VALUE histogram = rb_ary_new2 (N_BUCKETS);
+  int i;
+
+  for (i = 0; i < N_BUCKETS; i++)
+    rb_ary_push (histogram, UINT2NUM (data->buckets[i]));
+
+  rb_hash_aset (hash, ID2SYM (rb_intern ("calls")), UINT2NUM (data->calls));
+  rb_hash_aset (hash, ID2SYM (rb_intern ("frames")), UINT2NUM (data->frames));
+  rb_hash_aset (hash, ID2SYM (rb_intern ("total")),
+                rb_float_new (data->total));
+  rb_hash_aset (hash, ID2SYM (rb_intern ("max")), rb_float_new (data->max));
+  rb_hash_aset (hash, ID2SYM (rb_intern ("mean")),
+                rb_float_new (data->frames ? data->total / data->frames : 0.0));
+  rb_hash_aset (hash, ID2SYM (rb_intern ("histogram")), histogram);
+
+  return hash;
+}
+
+static VALUE
+rbclt_stats_get (VALUE self, VALUE category)
+{
+  return rbclt_stats_category_to_hash (rbclt_stats_data
+                                       + rbclt_stats_lookup_category
+                                       (category));
+}
+
+static VALUE
+rbclt_stats_to_h (VALUE self)
+{
+  VALUE hash = rb_hash_new ();
+  int i;
+
+  for (i = 0; i < RBCLT_STATS_N_CATEGORIES; i++)
+    rb_hash_aset (hash, ID2SYM (rb_intern (rbclt_stats_names[i])),
+                  rbclt_stats_category_to_hash (rbclt_stats_data + i));
+
+  return hash;
+}
+
+static void
+rbclt_stats_append_double (GString *buf, const char *name, gdouble value)
+{
+  gchar num[G_ASCII_DTOSTR_BUF_SIZE];
+
+  /* The C library formatting uses the decimal point of the current
+     locale which wouldn't be valid JSON */
+  g_string_append_printf (buf, ",\"%s\":%s", name,
+                          g_ascii_formatd (num, sizeof (num), "%.1f", value));
+}
+
+static VALUE
+rbclt_stats_to_json (VALUE self)
+{
+  GString *buf = g_string_new (NULL);
+  VALUE ret;
+  int i, j;
+
+  g_string_append_printf (buf, "{\"frames\":%u", rbclt_stats_n_frames);
+
+  for (i = 0; i < RBCLT_STATS_N_CATEGORIES; i++)
+    {
+      const RBCLTStatsData *data = rbclt_stats_data + i;
+
+      g_string_append_printf (buf, ",\"%s\":{\"calls\":%u,\"frames\":%u",
+                              rbclt_stats_names[i],
+                              data->calls, data->frames);
+      rbclt_stats_append_double (buf, "total", data->total);
+      rbclt_stats_append_double (buf, "max", data->max);
+      rbclt_stats_append_double (buf, "mean", data->frames
+                                 ? data->total / data->frames : 0.0);
+      g_string_append (buf, ",\"histogram\":[");
+
+      for (j = 0; j < N_BUCKETS; j++)
+        g_string_append_printf (buf, j ? ",%u" : "%u", data->buckets[j]);
+
+      g_string_append (buf, "]}");
+    }
+
+  g_string_append_c (buf, '}');
+
+  ret = rb_str_new (buf->str, buf->len);
+  g_string_free (buf, TRUE);
+
+  return ret;
+}
+
+void
+rbclt_stats_init ()
+{
+  VALUE mod = rb_define_module_under (rbclt_c_clutter, "Stats");
+
+  rb_define_const (mod, "N_BUCKETS", INT2NUM (N_BUCKETS));
+
+  rb_define_module_function (mod, "enable", rbclt_stats_enable, 0);
+  rb_define_module_function (mod, "disable", rbclt_stats_disable, 0);
+  rb_define_module_function (mod, "enabled?", rbclt_stats_is_enabled, 0);
+  rb_define_module_function (mod, "reset", rbclt_stats_reset, 0);
+  rb_define_module_function (mod, "n_frames", rbclt_stats_get_n_frames, 0);
+  rb_define_module_function (mod, "categories",
+                             rbclt_stats_get_categories, 0);
+  rb_define_module_function (mod, "[]", rbclt_stats_get, 1);
+  rb_define_module_function (mod, "to_h", rbclt_stats_to_h, 0);
+  rb_define_module_function (mod, "to_json", rbclt_stats_to_json, 0);
+}
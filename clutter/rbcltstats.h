@@ -0,0 +1,46 @@
+/* Ruby bindings for the Clutter 'interactive canvas' library.
+ * Copyright (C) 2010  Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#ifndef _RBCLT_STATS_H
+#define _RBCLT_STATS_H
+
+#include <glib.h>
+
+typedef enum
+{
+  RBCLT_STATS_PAINT,
+  RBCLT_STATS_LAYOUT,
+  RBCLT_STATS_PICK,
+  RBCLT_STATS_EVENT,
+  RBCLT_STATS_TIMELINE,
+  RBCLT_STATS_ALPHA,
+  RBCLT_STATS_FRAME_SOURCE,
+
+  RBCLT_STATS_N_CATEGORIES
+} RBCLTStatsCategory;
+
+extern gboolean rbclt_stats_enabled;
+
+/* Returns a timestamp in microseconds to pass to rbclt_stats_end.
+   These do nothing unless stats are enabled so they are cheap enough
+   to wrap around every callback */
+gdouble rbclt_stats_begin (void);
+void rbclt_stats_end (RBCLTStatsCategory category, gdouble start);
+
+#endif /* _RBCLT_STATS_H */
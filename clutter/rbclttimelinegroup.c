@@ -0,0 +1,348 @@
+/* Ruby bindings for the Clutter 'interactive canvas' library.
+ * Copyright (C) 2010  Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#include <rbgobject.h>
+#include <clutter/clutter.h>
+
+#include "rbclutter.h"
+#include "rbcltstats.h"
+
+/* A timeline group collects the new-frame signals from all of its
+   timelines in C and then calls a single Ruby callback once per frame
+   with all of the timelines that advanced. This avoids marshalling a
+   separate signal emission into Ruby for each timeline */
+
+typedef struct _RBCLTTimelineGroup RBCLTTimelineGroup;
+typedef struct _RBCLTTimelineGroupMember RBCLTTimelineGroupMember;
+
+struct _RBCLTTimelineGroupMember
+{
+  ClutterTimeline *timeline;
+  gulong new_frame_handler;
+};
+
+struct _RBCLTTimelineGroup
+{
+  /* Array of RBCLTTimelineGroupMember */
+  GArray *members;
+  /* Timelines that have emitted new-frame since the last dispatch */
+  GPtrArray *pending;
+  VALUE callback;
+  guint repaint_func;
+  /* The wrapper object. Its address is registered with the garbage
+     collector while the group has any members so that the group
+     keeps dispatching even if Ruby drops all references to it */
+  VALUE self;
+};
+
+static void
+rbclt_timeline_group_mark (void *data)
+{
+  RBCLTTimelineGroup *group = data;
+
+  rb_gc_mark (group->callback);
+}
+
+static void
+rbclt_timeline_group_free (void *data)
+{
+  RBCLTTimelineGroup *group = data;
+  guint i;
+
+  if (group->repaint_func)
+    clutter_threads_remove_repaint_func (group->repaint_func);
+
+  for (i = 0; i < group->members->len; i++)
+    {
+      RBCLTTimelineGroupMember *member
+        = &g_array_index (group->members, RBCLTTimelineGroupMember, i);
+
+      g_signal_handler_disconnect (member->timeline,
+                                   member->new_frame_handler);
+      g_object_unref (member->timeline);
+    }
+
+  g_array_free (group->members, TRUE);
+  g_ptr_array_free (group->pending, TRUE);
+  g_slice_free (RBCLTTimelineGroup, group);
+}
+
+static VALUE
+rbclt_timeline_group_alloc_with_class (VALUE klass)
+{
+  RBCLTTimelineGroup *group = g_slice_new (RBCLTTimelineGroup);
+
+  group->members = g_array_new (FALSE, FALSE,
+                                sizeof (RBCLTTimelineGroupMember));
+  group->pending = g_ptr_array_new ();
+  group->callback = Qnil;
+  group->repaint_func = 0;
+
+  return group->self = Data_Wrap_Struct (klass, rbclt_timeline_group_mark,
+                                         rbclt_timeline_group_free, group);
+}
+
+static RBCLTTimelineGroup *
+rbclt_timeline_group_get_pointer (VALUE self)
+{
+  RBCLTTimelineGroup *group;
+
+  Data_Get_Struct (self, RBCLTTimelineGroup, group);
+
+  return group;
+}
+
+static int
+rbclt_timeline_group_find (RBCLTTimelineGroup *group,
+                           ClutterTimeline *timeline)
+{
+  guint i;
+
+  for (i = 0; i < group->members->len; i++)
+    if (g_array_index (group->members, RBCLTTimelineGroupMember,
+                       i).timeline == timeline)
+      return i;
+
+  return -1;
+}
+
+static void
+rbclt_timeline_group_on_new_frame (ClutterTimeline *timeline,
+                                   gint msecs,
+                                   RBCLTTimelineGroup *group)
+{
+  g_ptr_array_add (group->pending, timeline);
+}
+
+static gboolean
+rbclt_timeline_group_dispatch (gpointer data)
+{
+  RBCLTTimelineGroup *group = data;
+  VALUE ticks, tick;
+  gdouble start;
+  guint i;
+
+  if (group->pending->len == 0 || NIL_P (group->callback))
+    {
+      g_ptr_array_set_size (group->pending, 0);
+      return TRUE;
+    }
+
+  start = rbclt_stats_begin ();
+
+  ticks = rb_ary_new2 (group->pending->len);
+
+  for (i = 0; i < group->pending->len; i++)
+    {
+      ClutterTimeline *timeline = g_ptr_array_index (group->pending, i);
+
+      tick = rb_ary_new2 (3);
+      rb_ary_push (tick, GOBJ2RVAL (timeline));
+      rb_ary_push (tick,
+                   UINT2NUM (clutter_timeline_get_elapsed_time (timeline)));
+      rb_ary_push (tick,
+                   rb_float_new (clutter_timeline_get_progress (timeline)));
+      rb_ary_push (ticks, tick);
+    }
+
+  /* Clear the pending list before calling Ruby in case the callback
+     causes any of the timelines to advance again */
+  g_ptr_array_set_size (group->pending, 0);
+
+  rb_funcall (group->callback, rb_intern ("call"), 1, ticks);
+
+  rbclt_stats_end (RBCLT_STATS_TIMELINE, start);
+
+  return TRUE;
+}
+
+static VALUE
+rbclt_timeline_group_initialize (int argc, VALUE *argv, VALUE self)
+{
+  RBCLTTimelineGroup *group = rbclt_timeline_group_get_pointer (self);
+  VALUE timelines, callback;
+  long i;
+
+  rb_scan_args (argc, argv, "01&", &timelines, &callback);
+
+  group->callback = callback;
+
+  /* Repaint functions are run once per frame after all of the
+     timelines have been advanced by the master clock */
+  group->repaint_func
+    = clutter_threads_add_repaint_func (rbclt_timeline_group_dispatch,
+                                        group, NULL);
+
+  if (!NIL_P (timelines))
+    {
+      timelines = rb_convert_type (timelines, T_ARRAY, "Array", "to_ary");
+
+      for (i = 0; i < RARRAY_LEN (timelines); i++)
+        rb_funcall (self, rb_intern ("add"), 1, RARRAY_PTR (timelines)[i]);
+    }
+
+  return Qnil;
+}
+
+static VALUE
+rbclt_timeline_group_on_frame (VALUE self)
+{
+  RBCLTTimelineGroup *group = rbclt_timeline_group_get_pointer (self);
+
+  rb_need_block ();
+  group->callback = rb_block_proc ();
+
+  return self;
+}
+
+static VALUE
+rbclt_timeline_group_add (VALUE self, VALUE timeline_arg)
+{
+  RBCLTTimelineGroup *group = rbclt_timeline_group_get_pointer (self);
+  ClutterTimeline *timeline = CLUTTER_TIMELINE (RVAL2GOBJ (timeline_arg));
+  RBCLTTimelineGroupMember member;
+
+  if (rbclt_timeline_group_find (group, timeline) != -1)
+    return self;
+
+  member.timeline = g_object_ref (timeline);
+  member.new_frame_handler
+    = g_signal_connect (timeline, "new-frame",
+                        G_CALLBACK (rbclt_timeline_group_on_new_frame),
+                        group);
+  g_array_append_val (group->members, member);
+
+  if (group->members->len == 1)
+    rb_gc_register_address (&group->self);
+
+  return self;
+}
+
+static VALUE
+rbclt_timeline_group_remove (VALUE self, VALUE timeline_arg)
+{
+  RBCLTTimelineGroup *group = rbclt_timeline_group_get_pointer (self);
+  ClutterTimeline *timeline = CLUTTER_TIMELINE (RVAL2GOBJ (timeline_arg));
+  RBCLTTimelineGroupMember *member;
+  int index;
+
+  if ((index = rbclt_timeline_group_find (group, timeline)) == -1)
+    return self;
+
+  member = &g_array_index (group->members, RBCLTTimelineGroupMember, index);
+  g_signal_handler_disconnect (timeline, member->new_frame_handler);
+  g_array_remove_index (group->members, index);
+
+  if (group->members->len == 0)
+    rb_gc_unregister_address (&group->self);
+
+  /* Don't report a frame for a timeline that is no longer in the
+     group */
+  while (g_ptr_array_remove (group->pending, timeline))
+    ;
+
+  g_object_unref (timeline);
+
+  return self;
+}
+
+static VALUE
+rbclt_timeline_group_get_timelines (VALUE self)
+{
+  RBCLTTimelineGroup *group = rbclt_timeline_group_get_pointer (self);
+  VALUE ret = rb_ary_new2 (group->members->len);
+  guint i;
+
+  for (i = 0; i < group->members->len; i++)
+    rb_ary_push (ret, GOBJ2RVAL (g_array_index (group->members,
+                                                RBCLTTimelineGroupMember,
+                                                i).timeline));
+
+  return ret;
+}
+
+static VALUE
+rbclt_timeline_group_get_size (VALUE self)
+{
+  RBCLTTimelineGroup *group = rbclt_timeline_group_get_pointer (self);
+
+  return UINT2NUM (group->members->len);
+}
+
+static VALUE
+rbclt_timeline_group_foreach (VALUE self, void (* func) (ClutterTimeline *))
+{
+  RBCLTTimelineGroup *group = rbclt_timeline_group_get_pointer (self);
+  guint i;
+
+  /* All of the timelines are changed together so that they will be
+     advanced in the same frames by the master clock */
+  for (i = 0; i < group->members->len; i++)
+    func (g_array_index (group->members, RBCLTTimelineGroupMember,
+                         i).timeline);
+
+  return self;
+}
+
+static VALUE
+rbclt_timeline_group_start (VALUE self)
+{
+  return rbclt_timeline_group_foreach (self, clutter_timeline_start);
+}
+
+static VALUE
+rbclt_timeline_group_pause (VALUE self)
+{
+  return rbclt_timeline_group_foreach (self, clutter_timeline_pause);
+}
+
+static VALUE
+rbclt_timeline_group_stop (VALUE self)
+{
+  return rbclt_timeline_group_foreach (self, clutter_timeline_stop);
+}
+
+static VALUE
+rbclt_timeline_group_rewind (VALUE self)
+{
+  return rbclt_timeline_group_foreach (self, clutter_timeline_rewind);
+}
+
+void
+rbclt_timeline_group_init ()
+{
+  VALUE klass = rb_define_class_under (rbclt_c_clutter, "TimelineGroup",
+                                       rb_cObject);
+
+  rb_define_alloc_func (klass, rbclt_timeline_group_alloc_with_class);
+
+  rb_define_method (klass, "initialize", rbclt_timeline_group_initialize, -1);
+  rb_define_method (klass, "on_frame", rbclt_timeline_group_on_frame, 0);
+  rb_define_method (klass, "add", rbclt_timeline_group_add, 1);
+  rb_define_alias (klass, "<<", "add");
+  rb_define_method (klass, "remove", rbclt_timeline_group_remove, 1);
+  rb_define_method (klass, "timelines",
+                    rbclt_timeline_group_get_timelines, 0);
+  rb_define_method (klass, "size", rbclt_timeline_group_get_size, 0);
+  rb_define_alias (klass, "length", "size");
+  rb_define_method (klass, "start", rbclt_timeline_group_start, 0);
+  rb_define_method (klass, "pause", rbclt_timeline_group_pause, 0);
+  rb_define_method (klass, "stop", rbclt_timeline_group_stop, 0);
+  rb_define_method (klass, "rewind", rbclt_timeline_group_rewind, 0);
+}
@@ -81,6 +81,13 @@ extern void rbclt_animatable_init ();
 extern void rbclt_fixed_layout_init ();
 
 extern void rbclt_effects_init ();
+extern void rbclt_stats_init ();
+extern void rbclt_curve_init ();
+extern void rbclt_timeline_group_init ();
+extern void rbclt_columnar_model_init ();
+extern void rbclt_list_view_init ();
+extern void rbclt_stage_capture_init ();
+extern void rbclt_offscreen_renderer_init ();
 
 extern void rb_cogl_init ();
 extern void rb_cogl_handle_init ();
@@ -90,9 +97,12 @@ extern void rb_cogl_shader_init ();
 extern void rb_cogl_program_init ();
 extern void rb_cogl_offscreen_init ();
 extern void rb_cogl_matrix_init ();
+extern void rb_cogl_matrix_array_init ();
 extern void rb_cogl_color_init ();
 extern void rb_cogl_material_init ();
 extern void rb_cogl_bitmap_init ();
+extern void rb_cogl_attribute_array_init ();
+extern void rb_cogl_vertex_layout_init ();
 extern void rb_cogl_vertex_buffer_init ();
 
 extern void rb_cogl_clip_init ();
@@ -363,6 +373,10 @@ Init_clutter ()
   rbclt_score_init ();
   rbclt_model_init ();
   rbclt_list_model_init ();
+  rbclt_columnar_model_init ();
+  rbclt_list_view_init ();
+  rbclt_stage_capture_init ();
+  rbclt_offscreen_renderer_init ();
   rbclt_fog_init ();
   rbclt_path_init ();
   rbclt_cairo_texture_init ();
@@ -373,6 +387,9 @@ Init_clutter ()
   rbclt_fixed_layout_init ();
 
   rbclt_effects_init ();
+  rbclt_stats_init ();
+  rbclt_curve_init ();
+  rbclt_timeline_group_init ();
 
   rb_cogl_init ();
   rb_cogl_handle_init ();
@@ -382,9 +399,12 @@ Init_clutter ()
   rb_cogl_program_init ();
   rb_cogl_offscreen_init ();
   rb_cogl_matrix_init ();
+  rb_cogl_matrix_array_init ();
   rb_cogl_color_init ();
   rb_cogl_material_init ();
   rb_cogl_bitmap_init ();
+  rb_cogl_attribute_array_init ();
+  rb_cogl_vertex_layout_init ();
   rb_cogl_vertex_buffer_init ();
 
   rb_cogl_clip_init ();
@@ -0,0 +1,419 @@
+/* Ruby bindings for the Clutter 'interactive canvas' library.
+ * Copyright (C) 2010  Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#include <rbgobject.h>
+#include <cogl/cogl.h>
+
+#include "rbclutter.h"
+#include "rbcoglattributearray.h"
+
+static VALUE rb_cogl_c_attribute_array;
+
+int
+rb_cogl_attribute_type_size (CoglAttributeType type)
+{
+  switch (type)
+    {
+    case COGL_ATTRIBUTE_TYPE_BYTE:
+    case COGL_ATTRIBUTE_TYPE_UNSIGNED_BYTE:
+      return sizeof (guint8);
+
+    case COGL_ATTRIBUTE_TYPE_SHORT:
+    case COGL_ATTRIBUTE_TYPE_UNSIGNED_SHORT:
+      return sizeof (guint16);
+
+    case COGL_ATTRIBUTE_TYPE_FLOAT:
+      return sizeof (gfloat);
+    }
+
+  rb_raise (rb_eRuntimeError, "Invalid CoglAttributeType");
+
+  return 1;
+}
+
+static void
+rb_cogl_attribute_array_free (void *data)
+{
+  RBCoglAttributeArray *array = data;
+
+  g_free (array->data);
+  g_slice_free (RBCoglAttributeArray, array);
+}
+
+static VALUE
+rb_cogl_attribute_array_alloc_with_class (VALUE klass)
+{
+  RBCoglAttributeArray *array = g_slice_new (RBCoglAttributeArray);
+
+  array->type = COGL_ATTRIBUTE_TYPE_FLOAT;
+  array->length = 0;
+  array->data = NULL;
+
+  return Data_Wrap_Struct (klass, 0, rb_cogl_attribute_array_free, array);
+}
+
+static void
+rb_cogl_attribute_array_resize (RBCoglAttributeArray *array,
+                                CoglAttributeType type,
+                                guint length)
+{
+  int type_size = rb_cogl_attribute_type_size (type);
+
+  g_free (array->data);
+  array->type = type;
+  array->length = length;
+  array->data = g_malloc0 (length * type_size);
+}
+
+VALUE
+rb_cogl_attribute_array_new (CoglAttributeType type, guint length)
+{
+  VALUE self = rb_cogl_attribute_array_alloc_with_class
+    (rb_cogl_c_attribute_array);
+
+  rb_cogl_attribute_array_resize (rb_cogl_attribute_array_get_pointer (self),
+                                  type, length);
+
+  return self;
+}
+
+RBCoglAttributeArray *
+rb_cogl_attribute_array_get_pointer (VALUE self)
+{
+  RBCoglAttributeArray *array;
+
+  Data_Get_Struct (self, RBCoglAttributeArray, array);
+
+  return array;
+}
+
+gboolean
+rb_cogl_is_kind_of_attribute_array (VALUE self)
+{
+  return (TYPE (self) == T_DATA
+          && RDATA (self)->dfree == rb_cogl_attribute_array_free);
+}
+
+void
+rb_cogl_assert_is_kind_of_attribute_array (VALUE arg)
+{
+  if (!rb_cogl_is_kind_of_attribute_array (arg))
+    rb_raise (rb_eTypeError, "wrong argument type");
+}
+
+float *
+rb_cogl_get_packed_floats (VALUE *value, long *n_floats)
+{
+  if (rb_cogl_is_kind_of_attribute_array (*value))
+    {
+      RBCoglAttributeArray *array = rb_cogl_attribute_array_get_pointer (*value);
+
+      if (array->type != COGL_ATTRIBUTE_TYPE_FLOAT)
+        rb_raise (rb_eArgError, "a float attribute array is required");
+
+      *n_floats = array->length;
+
+      return array->data;
+    }
+  else
+    {
+      /* Strings are copied so that the original is left untouched */
+      VALUE str = rb_str_dup (StringValue (*value));
+
+      if (RSTRING_LEN (str) % sizeof (float))
+        rb_raise (rb_eArgError, "data length is not a multiple of "
+                  "the size of a float");
+
+      rb_str_modify (str);
+      *value = str;
+      *n_floats = RSTRING_LEN (str) / sizeof (float);
+
+      return (float *) RSTRING_PTR (str);
+    }
+}
+
+static VALUE
+rb_cogl_attribute_array_fetch (RBCoglAttributeArray *array, guint index_num)
+{
+  switch (array->type)
+    {
+    case COGL_ATTRIBUTE_TYPE_BYTE:
+      return INT2FIX (((gint8 *) array->data)[index_num]);
+
+    case COGL_ATTRIBUTE_TYPE_UNSIGNED_BYTE:
+      return INT2FIX (((guint8 *) array->data)[index_num]);
+
+    case COGL_ATTRIBUTE_TYPE_SHORT:
+      return INT2FIX (((gint16 *) array->data)[index_num]);
+
+    case COGL_ATTRIBUTE_TYPE_UNSIGNED_SHORT:
+      return INT2FIX (((guint16 *) array->data)[index_num]);
+
+    case COGL_ATTRIBUTE_TYPE_FLOAT:
+      return rb_float_new (((gfloat *) array->data)[index_num]);
+    }
+
+  return Qnil;
+}
+
+void
+rb_cogl_attribute_value_store (CoglAttributeType type,
+                               gpointer dest,
+                               VALUE value)
+{
+  switch (type)
+    {
+    case COGL_ATTRIBUTE_TYPE_BYTE:
+      *(gint8 *) dest = NUM2INT (value);
+      break;
+
+    case COGL_ATTRIBUTE_TYPE_UNSIGNED_BYTE:
+      *(guint8 *) dest = rbclt_num_to_guint8 (value);
+      break;
+
+    case COGL_ATTRIBUTE_TYPE_SHORT:
+      *(gint16 *) dest = NUM2INT (value);
+      break;
+
+    case COGL_ATTRIBUTE_TYPE_UNSIGNED_SHORT:
+      *(guint16 *) dest = rbclt_num_to_guint16 (value);
+      break;
+
+    case COGL_ATTRIBUTE_TYPE_FLOAT:
+      *(gfloat *) dest = NUM2DBL (value);
+      break;
+    }
+}
+
+void
+rb_cogl_attribute_array_store (RBCoglAttributeArray *array,
+                               guint index_num,
+                               VALUE value)
+{
+  rb_cogl_attribute_value_store (array->type,
+                                 (guint8 *) array->data
+                                 + index_num
+                                 * rb_cogl_attribute_type_size (array->type),
+                                 value);
+}
+
+static void
+rb_cogl_attribute_array_set_range (VALUE self, guint offset, VALUE values)
+{
+  RBCoglAttributeArray *array = rb_cogl_attribute_array_get_pointer (self);
+  int type_size = rb_cogl_attribute_type_size (array->type);
+  long i, n_values;
+
+  if (TYPE (values) == T_ARRAY)
+    {
+      n_values = RARRAY_LEN (values);
+
+      if (offset > array->length || n_values > array->length - offset)
+        rb_raise (rb_eArgError, "index out of range");
+
+      /* Converting the values may call back into Ruby so the length
+         of the source array is checked again on each iteration */
+      for (i = 0; i < n_values && i < RARRAY_LEN (values); i++)
+        rb_cogl_attribute_array_store (array, offset + i,
+                                       RARRAY_PTR (values)[i]);
+    }
+  else if (rb_cogl_is_kind_of_attribute_array (values))
+    {
+      RBCoglAttributeArray *other = rb_cogl_attribute_array_get_pointer (values);
+
+      if (other->type != array->type)
+        rb_raise (rb_eArgError, "attribute array types do not match");
+
+      if (offset > array->length || other->length > array->length - offset)
+        rb_raise (rb_eArgError, "index out of range");
+
+      memmove ((guint8 *) array->data + offset * type_size,
+               other->data, other->length * type_size);
+    }
+  else
+    {
+      /* Otherwise treat the value as a string of packed data in the
+         native layout of the array */
+      StringValue (values);
+
+      if (RSTRING_LEN (values) % type_size)
+        rb_raise (rb_eArgError, "data length is not a multiple of "
+                  "the element size");
+
+      n_values = RSTRING_LEN (values) / type_size;
+
+      if (offset > array->length || n_values > array->length - offset)
+        rb_raise (rb_eArgError, "index out of range");
+
+      memcpy ((guint8 *) array->data + offset * type_size,
+              RSTRING_PTR (values), RSTRING_LEN (values));
+    }
+}
+
+static VALUE
+rb_cogl_attribute_array_initialize (VALUE self, VALUE type_arg, VALUE size)
+{
+  RBCoglAttributeArray *array = rb_cogl_attribute_array_get_pointer (self);
+  CoglAttributeType type = RVAL2GENUM (type_arg, COGL_TYPE_ATTRIBUTE_TYPE);
+
+  /* The size can either be a number of elements or an array of
+     initial values */
+  if (TYPE (size) == T_ARRAY)
+    {
+      rb_cogl_attribute_array_resize (array, type, RARRAY_LEN (size));
+      rb_cogl_attribute_array_set_range (self, 0, size);
+    }
+  else
+    rb_cogl_attribute_array_resize (array, type, NUM2UINT (size));
+
+  return Qnil;
+}
+
+static VALUE
+rb_cogl_attribute_array_initialize_copy (VALUE self, VALUE orig)
+{
+  RBCoglAttributeArray *array_self, *array_orig;
+
+  rb_cogl_assert_is_kind_of_attribute_array (orig);
+
+  array_self = rb_cogl_attribute_array_get_pointer (self);
+  array_orig = rb_cogl_attribute_array_get_pointer (orig);
+
+  rb_cogl_attribute_array_resize (array_self, array_orig->type,
+                                  array_orig->length);
+  memcpy (array_self->data, array_orig->data,
+          array_orig->length * rb_cogl_attribute_type_size (array_orig->type));
+
+  return Qnil;
+}
+
+static VALUE
+rb_cogl_attribute_array_get_type (VALUE self)
+{
+  RBCoglAttributeArray *array = rb_cogl_attribute_array_get_pointer (self);
+
+  return GENUM2RVAL (array->type, COGL_TYPE_ATTRIBUTE_TYPE);
+}
+
+static VALUE
+rb_cogl_attribute_array_get_length (VALUE self)
+{
+  RBCoglAttributeArray *array = rb_cogl_attribute_array_get_pointer (self);
+
+  return UINT2NUM (array->length);
+}
+
+static VALUE
+rb_cogl_attribute_array_get_bytesize (VALUE self)
+{
+  RBCoglAttributeArray *array = rb_cogl_attribute_array_get_pointer (self);
+
+  return UINT2NUM (array->length * rb_cogl_attribute_type_size (array->type));
+}
+
+static VALUE
+rb_cogl_attribute_array_aref (VALUE self, VALUE index_value)
+{
+  RBCoglAttributeArray *array = rb_cogl_attribute_array_get_pointer (self);
+  int index_num = NUM2INT (index_value);
+
+  if (index_num < 0 || index_num >= array->length)
+    rb_raise (rb_eArgError, "index out of range");
+
+  return rb_cogl_attribute_array_fetch (array, index_num);
+}
+
+static VALUE
+rb_cogl_attribute_array_aset (VALUE self, VALUE index_value, VALUE value)
+{
+  RBCoglAttributeArray *array = rb_cogl_attribute_array_get_pointer (self);
+  int index_num = NUM2INT (index_value);
+
+  if (index_num < 0 || index_num >= array->length)
+    rb_raise (rb_eArgError, "index out of range");
+
+  rb_cogl_attribute_array_store (array, index_num, value);
+
+  return value;
+}
+
+static VALUE
+rb_cogl_attribute_array_set (int argc, VALUE *argv, VALUE self)
+{
+  VALUE offset, values;
+
+  /* Either set(values) to replace from the start or set(offset,
+     values) */
+  if (rb_scan_args (argc, argv, "11", &offset, &values) == 1)
+    {
+      values = offset;
+      offset = INT2FIX (0);
+    }
+
+  rb_cogl_attribute_array_set_range (self, NUM2UINT (offset), values);
+
+  return self;
+}
+
+static VALUE
+rb_cogl_attribute_array_to_a (VALUE self)
+{
+  RBCoglAttributeArray *array = rb_cogl_attribute_array_get_pointer (self);
+  VALUE result = rb_ary_new2 (array->length);
+  guint i;
+
+  for (i = 0; i < array->length; i++)
+    rb_ary_push (result, rb_cogl_attribute_array_fetch (array, i));
+
+  return result;
+}
+
+static VALUE
+rb_cogl_attribute_array_to_s (VALUE self)
+{
+  RBCoglAttributeArray *array = rb_cogl_attribute_array_get_pointer (self);
+
+  return rb_str_new (array->data,
+                     array->length * rb_cogl_attribute_type_size (array->type));
+}
+
+void
+rb_cogl_attribute_array_init ()
+{
+  VALUE klass;
+
+  klass = rb_define_class_under (rbclt_c_cogl, "AttributeArray", rb_cObject);
+  rb_cogl_c_attribute_array = klass;
+
+  rb_define_alloc_func (klass, rb_cogl_attribute_array_alloc_with_class);
+
+  rb_define_method (klass, "initialize", rb_cogl_attribute_array_initialize, 2);
+  rb_define_method (klass, "initialize_copy",
+                    rb_cogl_attribute_array_initialize_copy, 1);
+  rb_define_method (klass, "type", rb_cogl_attribute_array_get_type, 0);
+  rb_define_method (klass, "length", rb_cogl_attribute_array_get_length, 0);
+  rb_define_alias (klass, "size", "length");
+  rb_define_method (klass, "bytesize",
+                    rb_cogl_attribute_array_get_bytesize, 0);
+  rb_define_method (klass, "[]", rb_cogl_attribute_array_aref, 1);
+  rb_define_method (klass, "[]=", rb_cogl_attribute_array_aset, 2);
+  rb_define_method (klass, "set", rb_cogl_attribute_array_set, -1);
+  rb_define_method (klass, "to_a", rb_cogl_attribute_array_to_a, 0);
+  rb_define_method (klass, "to_s", rb_cogl_attribute_array_to_s, 0);
+}
@@ -0,0 +1,62 @@
+/* Ruby bindings for the Clutter 'interactive canvas' library.
+ * Copyright (C) 2010  Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#ifndef _RB_COGL_ATTRIBUTE_ARRAY_H
+#define _RB_COGL_ATTRIBUTE_ARRAY_H
+
+#include <ruby.h>
+#include <cogl/cogl.h>
+
+typedef struct _RBCoglAttributeArray RBCoglAttributeArray;
+
+struct _RBCoglAttributeArray
+{
+  CoglAttributeType type;
+  /* Number of elements, not bytes */
+  guint length;
+  gpointer data;
+};
+
+/* Allocates a zero-filled array of the given type wrapped in a VALUE */
+VALUE rb_cogl_attribute_array_new (CoglAttributeType type, guint length);
+
+RBCoglAttributeArray *rb_cogl_attribute_array_get_pointer (VALUE self);
+
+gboolean rb_cogl_is_kind_of_attribute_array (VALUE self);
+void rb_cogl_assert_is_kind_of_attribute_array (VALUE arg);
+
+/* Converts a Ruby number to the given type and writes it to dest */
+void rb_cogl_attribute_value_store (CoglAttributeType type,
+                                    gpointer dest,
+                                    VALUE value);
+
+/* Converts a Ruby number and stores it at the given element index
+   without any range checking */
+void rb_cogl_attribute_array_store (RBCoglAttributeArray *array,
+                                    guint index_num,
+                                    VALUE value);
+
+/* Gets a writable pointer to packed float data. A float attribute
+   array is modified in place. A string is copied and value is
+   replaced with the copy */
+float *rb_cogl_get_packed_floats (VALUE *value, long *n_floats);
+
+int rb_cogl_attribute_type_size (CoglAttributeType type);
+
+#endif /* _RB_COGL_ATTRIBUTE_ARRAY_H */
@@ -21,6 +21,7 @@
 
 #include "rbclutter.h"
 #include "rbcoglmatrix.h"
+#include "rbcoglattributearray.h"
 
 static VALUE rb_cogl_c_matrix;
 
@@ -293,6 +294,130 @@ rb_cogl_matrix_transform_point (VALUE self, VALUE x, VALUE y, VALUE z, VALUE w)
                       rb_float_new (w_out));
 }
 
+void
+rb_cogl_matrix_transform_points_in_place (const CoglMatrix *matrix,
+                                          float *points,
+                                          int n_components,
+                                          guint n_points)
+{
+  float x, y, z, w;
+  guint i;
+
+  /* This is the same calculation as cogl_matrix_transform_point but
+     done in a single loop without a function call per point. Missing
+     components default to z = 0 and w = 1 */
+  switch (n_components)
+    {
+    case 2:
+      for (i = 0; i < n_points; i++, points += 2)
+        {
+          x = points[0];
+          y = points[1];
+          points[0] = matrix->xx * x + matrix->xy * y + matrix->xw;
+          points[1] = matrix->yx * x + matrix->yy * y + matrix->yw;
+        }
+      break;
+
+    case 3:
+      for (i = 0; i < n_points; i++, points += 3)
+        {
+          x = points[0];
+          y = points[1];
+          z = points[2];
+          points[0] = matrix->xx * x + matrix->xy * y + matrix->xz * z
+            + matrix->xw;
+          points[1] = matrix->yx * x + matrix->yy * y + matrix->yz * z
+            + matrix->yw;
+          points[2] = matrix->zx * x + matrix->zy * y + matrix->zz * z
+            + matrix->zw;
+        }
+      break;
+
+    case 4:
+      for (i = 0; i < n_points; i++, points += 4)
+        {
+          x = points[0];
+          y = points[1];
+          z = points[2];
+          w = points[3];
+          points[0] = matrix->xx * x + matrix->xy * y + matrix->xz * z
+            + matrix->xw * w;
+          points[1] = matrix->yx * x + matrix->yy * y + matrix->yz * z
+            + matrix->yw * w;
+          points[2] = matrix->zx * x + matrix->zy * y + matrix->zz * z
+            + matrix->zw * w;
+          points[3] = matrix->wx * x + matrix->wy * y + matrix->wz * z
+            + matrix->ww * w;
+        }
+      break;
+    }
+}
+
+static VALUE
+rb_cogl_matrix_transform_points (int argc, VALUE *argv, VALUE self)
+{
+  VALUE points, n_components_arg, output;
+  CoglMatrix *matrix;
+  int n_components;
+  long n_floats;
+  float *data;
+
+  rb_scan_args (argc, argv, "21", &points, &n_components_arg, &output);
+
+  Data_Get_Struct (self, CoglMatrix, matrix);
+
+  n_components = NUM2INT (n_components_arg);
+  if (n_components < 2 || n_components > 4)
+    rb_raise (rb_eArgError, "the number of components must be 2, 3 or 4");
+
+  if (NIL_P (output))
+    /* Transform a float attribute array in place or a copy of a
+       string */
+    data = rb_cogl_get_packed_floats (&points, &n_floats);
+  else
+    {
+      long n_input_floats;
+      const float *input;
+
+      rb_cogl_assert_is_kind_of_attribute_array (output);
+
+      /* The input is only read so a string doesn't need copying */
+      if (TYPE (points) == T_STRING)
+        {
+          if (RSTRING_LEN (points) % sizeof (float))
+            rb_raise (rb_eArgError, "data length is not a multiple of "
+                      "the size of a float");
+
+          input = (const float *) RSTRING_PTR (points);
+          n_input_floats = RSTRING_LEN (points) / sizeof (float);
+        }
+      else
+        input = rb_cogl_get_packed_floats (&points, &n_input_floats);
+
+      data = rb_cogl_get_packed_floats (&output, &n_floats);
+
+      /* Everything is checked before the output is overwritten */
+      if (n_floats != n_input_floats)
+        rb_raise (rb_eArgError, "the output is not the same size "
+                  "as the input");
+      if (n_floats % n_components)
+        rb_raise (rb_eArgError, "data length is not a multiple of "
+                  "the number of components");
+
+      memmove (data, input, n_floats * sizeof (float));
+      points = output;
+    }
+
+  if (n_floats % n_components)
+    rb_raise (rb_eArgError, "data length is not a multiple of "
+              "the number of components");
+
+  rb_cogl_matrix_transform_points_in_place (matrix, data, n_components,
+                                            n_floats / n_components);
+
+  return points;
+}
+
 #define RB_COGL_DEFINE_ACCESSOR_FUNC(member)          \
   static VALUE                                  \
   rb_cogl_matrix_get_ ## member (VALUE self)     \
@@ -352,6 +477,8 @@ rb_cogl_matrix_init ()
   rb_define_method (klass, "inverse", rb_cogl_matrix_get_inverse, 0);
   rb_define_method (klass, "transform_point",
                     rb_cogl_matrix_transform_point, 4);
+  rb_define_method (klass, "transform_points",
+                    rb_cogl_matrix_transform_points, -1);
 
   RB_COGL_DEFINE_ACCESSOR (xx);
   RB_COGL_DEFINE_ACCESSOR (yx);
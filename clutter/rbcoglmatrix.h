@@ -31,4 +31,11 @@ CoglMatrix *rb_cogl_matrix_get_pointer (VALUE self);
 gboolean rb_cogl_is_kind_of_matrix (VALUE self);
 void rb_cogl_assert_is_kind_of_matrix (VALUE arg);
 
+/* Transforms an array of packed points with 2, 3 or 4 components
+   each */
+void rb_cogl_matrix_transform_points_in_place (const CoglMatrix *matrix,
+                                               float *points,
+                                               int n_components,
+                                               guint n_points);
+
 #endif /* _RB_COGL_MATRIX_H */
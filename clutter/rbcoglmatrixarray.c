@@ -0,0 +1,287 @@
+/* Ruby bindings for the Clutter 'interactive canvas' library.
+ * Copyright (C) 2010  Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#include <cogl/cogl.h>
+
+#include "rbclutter.h"
+#include "rbcoglmatrix.h"
+#include "rbcoglattributearray.h"
+
+typedef struct _RBCoglMatrixArray RBCoglMatrixArray;
+
+struct _RBCoglMatrixArray
+{
+  guint length;
+  CoglMatrix *matrices;
+};
+
+static void
+rb_cogl_matrix_array_free (void *data)
+{
+  RBCoglMatrixArray *array = data;
+
+  g_free (array->matrices);
+  g_slice_free (RBCoglMatrixArray, array);
+}
+
+static VALUE
+rb_cogl_matrix_array_alloc_with_class (VALUE klass)
+{
+  RBCoglMatrixArray *array = g_slice_new (RBCoglMatrixArray);
+
+  array->length = 0;
+  array->matrices = NULL;
+
+  return Data_Wrap_Struct (klass, 0, rb_cogl_matrix_array_free, array);
+}
+
+static RBCoglMatrixArray *
+rb_cogl_matrix_array_get_pointer (VALUE self)
+{
+  RBCoglMatrixArray *array;
+
+  Data_Get_Struct (self, RBCoglMatrixArray, array);
+
+  return array;
+}
+
+static CoglMatrix *
+rb_cogl_matrix_array_get_matrix (RBCoglMatrixArray *array, VALUE index_value)
+{
+  int index_num = NUM2INT (index_value);
+
+  if (index_num < 0 || index_num >= array->length)
+    rb_raise (rb_eArgError, "index out of range");
+
+  return array->matrices + index_num;
+}
+
+static VALUE
+rb_cogl_matrix_array_initialize (VALUE self, VALUE length)
+{
+  RBCoglMatrixArray *array = rb_cogl_matrix_array_get_pointer (self);
+  guint i;
+
+  g_free (array->matrices);
+  array->length = NUM2UINT (length);
+  array->matrices = g_new (CoglMatrix, array->length);
+
+  for (i = 0; i < array->length; i++)
+    cogl_matrix_init_identity (array->matrices + i);
+
+  return Qnil;
+}
+
+static VALUE
+rb_cogl_matrix_array_initialize_copy (VALUE self, VALUE orig)
+{
+  RBCoglMatrixArray *array_self, *array_orig;
+
+  if (TYPE (orig) != T_DATA
+      || RDATA (orig)->dfree != rb_cogl_matrix_array_free)
+    rb_raise (rb_eTypeError, "wrong argument type");
+
+  array_self = rb_cogl_matrix_array_get_pointer (self);
+  array_orig = rb_cogl_matrix_array_get_pointer (orig);
+
+  g_free (array_self->matrices);
+  array_self->length = array_orig->length;
+  array_self->matrices = g_memdup (array_orig->matrices,
+                                   sizeof (CoglMatrix) * array_orig->length);
+
+  return Qnil;
+}
+
+static VALUE
+rb_cogl_matrix_array_get_length (VALUE self)
+{
+  RBCoglMatrixArray *array = rb_cogl_matrix_array_get_pointer (self);
+
+  return UINT2NUM (array->length);
+}
+
+static VALUE
+rb_cogl_matrix_array_aref (VALUE self, VALUE index_value)
+{
+  RBCoglMatrixArray *array = rb_cogl_matrix_array_get_pointer (self);
+  CoglMatrix *matrix = rb_cogl_matrix_array_get_matrix (array, index_value);
+  VALUE result = rb_cogl_matrix_alloc ();
+
+  *rb_cogl_matrix_get_pointer (result) = *matrix;
+
+  return result;
+}
+
+static VALUE
+rb_cogl_matrix_array_aset (VALUE self, VALUE index_value, VALUE matrix_arg)
+{
+  RBCoglMatrixArray *array = rb_cogl_matrix_array_get_pointer (self);
+  CoglMatrix *matrix = rb_cogl_matrix_array_get_matrix (array, index_value);
+
+  rb_cogl_assert_is_kind_of_matrix (matrix_arg);
+
+  *matrix = *rb_cogl_matrix_get_pointer (matrix_arg);
+
+  return matrix_arg;
+}
+
+static VALUE
+rb_cogl_matrix_array_get_element (VALUE self, VALUE index_value,
+                                  VALUE element_value)
+{
+  RBCoglMatrixArray *array = rb_cogl_matrix_array_get_pointer (self);
+  CoglMatrix *matrix = rb_cogl_matrix_array_get_matrix (array, index_value);
+  int element = NUM2INT (element_value);
+
+  if (element < 0 || element >= 16)
+    rb_raise (rb_eArgError, "element out of range");
+
+  return rb_float_new ((&matrix->xx)[element]);
+}
+
+static VALUE
+rb_cogl_matrix_array_set_element (VALUE self, VALUE index_value,
+                                  VALUE element_value, VALUE value)
+{
+  RBCoglMatrixArray *array = rb_cogl_matrix_array_get_pointer (self);
+  CoglMatrix *matrix = rb_cogl_matrix_array_get_matrix (array, index_value);
+  int element = NUM2INT (element_value);
+  CoglMatrix copy;
+
+  if (element < 0 || element >= 16)
+    rb_raise (rb_eArgError, "element out of range");
+
+  /* Go through cogl_matrix_init_from_array so that Cogl can update
+     any private state it keeps in the matrix */
+  copy = *matrix;
+  (&copy.xx)[element] = NUM2DBL (value);
+  cogl_matrix_init_from_array (matrix, &copy.xx);
+
+  return value;
+}
+
+static VALUE
+rb_cogl_matrix_array_multiply_bang (VALUE self, VALUE matrix_arg)
+{
+  RBCoglMatrixArray *array = rb_cogl_matrix_array_get_pointer (self);
+  CoglMatrix *matrix, tmp;
+  guint i;
+
+  rb_cogl_assert_is_kind_of_matrix (matrix_arg);
+  matrix = rb_cogl_matrix_get_pointer (matrix_arg);
+
+  for (i = 0; i < array->length; i++)
+    {
+      tmp = array->matrices[i];
+      cogl_matrix_multiply (array->matrices + i, &tmp, matrix);
+    }
+
+  return self;
+}
+
+static VALUE
+rb_cogl_matrix_array_premultiply_bang (VALUE self, VALUE matrix_arg)
+{
+  RBCoglMatrixArray *array = rb_cogl_matrix_array_get_pointer (self);
+  CoglMatrix *matrix, tmp;
+  guint i;
+
+  rb_cogl_assert_is_kind_of_matrix (matrix_arg);
+  matrix = rb_cogl_matrix_get_pointer (matrix_arg);
+
+  for (i = 0; i < array->length; i++)
+    {
+      tmp = array->matrices[i];
+      cogl_matrix_multiply (array->matrices + i, matrix, &tmp);
+    }
+
+  return self;
+}
+
+static VALUE
+rb_cogl_matrix_array_invert_bang (VALUE self)
+{
+  RBCoglMatrixArray *array = rb_cogl_matrix_array_get_pointer (self);
+  CoglMatrix inverse;
+  guint i;
+
+  /* Matrices that can't be inverted are left untouched */
+  for (i = 0; i < array->length; i++)
+    if (cogl_matrix_get_inverse (array->matrices + i, &inverse))
+      array->matrices[i] = inverse;
+
+  return self;
+}
+
+static VALUE
+rb_cogl_matrix_array_transform_points (VALUE self, VALUE points,
+                                       VALUE n_components_arg)
+{
+  RBCoglMatrixArray *array = rb_cogl_matrix_array_get_pointer (self);
+  int n_components = NUM2INT (n_components_arg);
+  long n_floats;
+  float *data;
+  guint i;
+
+  if (n_components < 2 || n_components > 4)
+    rb_raise (rb_eArgError, "the number of components must be 2, 3 or 4");
+
+  data = rb_cogl_get_packed_floats (&points, &n_floats);
+
+  /* Each matrix transforms the point with the same index */
+  if (n_floats != (long) array->length * n_components)
+    rb_raise (rb_eArgError, "expected %u points", array->length);
+
+  for (i = 0; i < array->length; i++)
+    rb_cogl_matrix_transform_points_in_place (array->matrices + i,
+                                              data + i * n_components,
+                                              n_components, 1);
+
+  return points;
+}
+
+void
+rb_cogl_matrix_array_init ()
+{
+  VALUE klass;
+
+  klass = rb_define_class_under (rbclt_c_cogl, "MatrixArray", rb_cObject);
+
+  rb_define_alloc_func (klass, rb_cogl_matrix_array_alloc_with_class);
+
+  rb_define_method (klass, "initialize", rb_cogl_matrix_array_initialize, 1);
+  rb_define_method (klass, "initialize_copy",
+                    rb_cogl_matrix_array_initialize_copy, 1);
+  rb_define_method (klass, "length", rb_cogl_matrix_array_get_length, 0);
+  rb_define_alias (klass, "size", "length");
+  rb_define_method (klass, "[]", rb_cogl_matrix_array_aref, 1);
+  rb_define_method (klass, "[]=", rb_cogl_matrix_array_aset, 2);
+  rb_define_method (klass, "get_element",
+                    rb_cogl_matrix_array_get_element, 2);
+  rb_define_method (klass, "set_element",
+                    rb_cogl_matrix_array_set_element, 3);
+
+  rb_define_method (klass, "multiply!",
+                    rb_cogl_matrix_array_multiply_bang, 1);
+  rb_define_method (klass, "premultiply!",
+                    rb_cogl_matrix_array_premultiply_bang, 1);
+  rb_define_method (klass, "invert!", rb_cogl_matrix_array_invert_bang, 0);
+  rb_define_method (klass, "transform_points",
+                    rb_cogl_matrix_array_transform_points, 2);
+}
@@ -21,8 +21,11 @@
 #include <cogl/cogl.h>
 
 #include "rbclutter.h"
+#include "rbcoglhandle.h"
+#include "rbcoglattributearray.h"
 
 typedef struct _PolyData PolyData;
+typedef struct _PathCallData PathCallData;
 
 struct _PolyData
 {
@@ -32,6 +35,18 @@ struct _PolyData
   void (* func) (const float *coords, gint num_points);
 };
 
+struct _PathCallData
+{
+  VALUE self;
+  CoglHandle old_path;
+  /* One of the Cogl.path_* implementations below and the number of
+     arguments it takes or -1 if it takes an argument array */
+  VALUE (* func) ();
+  int arity;
+  int argc;
+  VALUE *argv;
+};
+
 static VALUE
 rb_cogl_set_source_color (int argc, VALUE *argv, VALUE self)
 {
@@ -273,9 +288,52 @@ rb_cogl_free_poly_data (VALUE data_value)
   return Qnil;
 }
 
+static VALUE
+rb_cogl_poly_func_packed (PolyData *data, VALUE arg)
+{
+  const float *points;
+  long n_floats;
+
+  if (rb_cogl_is_kind_of_attribute_array (arg))
+    {
+      RBCoglAttributeArray *array = rb_cogl_attribute_array_get_pointer (arg);
+
+      if (array->type != COGL_ATTRIBUTE_TYPE_FLOAT)
+        rb_raise (rb_eArgError, "a float attribute array is required");
+
+      points = array->data;
+      n_floats = array->length;
+    }
+  else
+    {
+      if (RSTRING_LEN (arg) % sizeof (float))
+        rb_raise (rb_eArgError, "data length is not a multiple of "
+                  "the size of a float");
+
+      points = (const float *) RSTRING_PTR (arg);
+      n_floats = RSTRING_LEN (arg) / sizeof (float);
+    }
+
+  if ((n_floats & 1))
+    rb_raise (rb_eArgError, "pairs of coordinates required");
+
+  /* The data is already in the layout Cogl expects so it can be
+     passed straight through */
+  (* data->func) (points, n_floats / 2);
+
+  return Qnil;
+}
+
 static VALUE
 rb_cogl_poly_func (PolyData *data)
 {
+  /* A single argument can be a packed string of floats or a float
+     attribute array instead of a list of numbers */
+  if (data->argc == 1
+      && (TYPE (data->argv[0]) == T_STRING
+          || rb_cogl_is_kind_of_attribute_array (data->argv[0])))
+    return rb_cogl_poly_func_packed (data, data->argv[0]);
+
   if ((data->argc & 1))
     rb_raise (rb_eArgError, "wrong number of arguments (pairs required)");
 
@@ -328,7 +386,152 @@ rb_cogl_path_dup (VALUE self)
   CoglPath *src = (CoglPath *) rb_cogl_handle_get_handle (self);
   CoglPath *dst = cogl_path_copy (src);
 
-  return rb_cogl_handle_get_handle (dst);
+  return rb_cogl_handle_to_value_unref (dst);
+}
+
+static VALUE
+rb_cogl_path_initialize (VALUE self)
+{
+  CoglHandle old_path = cogl_handle_ref (cogl_get_path ());
+  CoglHandle path;
+
+  /* cogl_path_new replaces the current path so we need to grab the
+     new path and then put the old one back */
+  cogl_path_new ();
+  path = cogl_handle_ref (cogl_get_path ());
+  cogl_set_path (old_path);
+  cogl_handle_unref (old_path);
+
+  rb_cogl_handle_initialize (self, path);
+
+  return Qnil;
+}
+
+static VALUE
+rb_cogl_path_do_call (VALUE data_value)
+{
+  PathCallData *data = (PathCallData *) data_value;
+
+  data->old_path = cogl_handle_ref (cogl_get_path ());
+  cogl_set_path (rb_cogl_handle_get_handle (data->self));
+
+  switch (data->arity)
+    {
+    case -1:
+      data->func (data->argc, data->argv, rbclt_c_cogl);
+      break;
+    case 0:
+      data->func (rbclt_c_cogl);
+      break;
+    case 2:
+      data->func (rbclt_c_cogl, data->argv[0], data->argv[1]);
+      break;
+    case 4:
+      data->func (rbclt_c_cogl, data->argv[0], data->argv[1],
+                  data->argv[2], data->argv[3]);
+      break;
+    case 6:
+      data->func (rbclt_c_cogl, data->argv[0], data->argv[1],
+                  data->argv[2], data->argv[3],
+                  data->argv[4], data->argv[5]);
+      break;
+    }
+
+  return data->self;
+}
+
+static VALUE
+rb_cogl_path_restore (VALUE data_value)
+{
+  PathCallData *data = (PathCallData *) data_value;
+
+  if (data->old_path != COGL_INVALID_HANDLE)
+    {
+      cogl_set_path (data->old_path);
+      cogl_handle_unref (data->old_path);
+    }
+
+  return Qnil;
+}
+
+/* Calls the implementation of one of the Cogl.path_* functions with
+   the path temporarily set as the current path. The path is modified
+   in place so drawing it again doesn't need to rebuild the list of
+   nodes from Ruby. Cogl 1.4 has no fill cache though; every fill
+   still goes through the stencil buffer */
+static VALUE
+rb_cogl_path_call (VALUE self, VALUE (* func) (), int arity,
+                   int argc, VALUE *argv)
+{
+  PathCallData data;
+
+  if (arity >= 0 && argc != arity)
+    rb_raise (rb_eArgError, "wrong number of arguments (%d for %d)",
+              argc, arity);
+
+  data.self = self;
+  data.old_path = COGL_INVALID_HANDLE;
+  data.func = func;
+  data.arity = arity;
+  data.argc = argc;
+  data.argv = argv;
+
+  return rb_ensure (rb_cogl_path_do_call, (VALUE) &data,
+                    rb_cogl_path_restore, (VALUE) &data);
+}
+
+#define RB_COGL_PATH_DEFINE_METHOD_FUNC(name, arity)                    \
+  static VALUE                                                          \
+  rb_cogl_path_m_ ## name (int argc, VALUE *argv, VALUE self)           \
+  {                                                                     \
+    return rb_cogl_path_call (self, rb_cogl_path_ ## name, (arity),     \
+                              argc, argv);                              \
+  }
+
+RB_COGL_PATH_DEFINE_METHOD_FUNC (move_to, 2)
+RB_COGL_PATH_DEFINE_METHOD_FUNC (rel_move_to, 2)
+RB_COGL_PATH_DEFINE_METHOD_FUNC (line_to, 2)
+RB_COGL_PATH_DEFINE_METHOD_FUNC (rel_line_to, 2)
+RB_COGL_PATH_DEFINE_METHOD_FUNC (arc, 6)
+RB_COGL_PATH_DEFINE_METHOD_FUNC (curve_to, 6)
+RB_COGL_PATH_DEFINE_METHOD_FUNC (rel_curve_to, 6)
+RB_COGL_PATH_DEFINE_METHOD_FUNC (close, 0)
+RB_COGL_PATH_DEFINE_METHOD_FUNC (line, 4)
+RB_COGL_PATH_DEFINE_METHOD_FUNC (rectangle, 4)
+RB_COGL_PATH_DEFINE_METHOD_FUNC (ellipse, 4)
+RB_COGL_PATH_DEFINE_METHOD_FUNC (round_rectangle, 6)
+RB_COGL_PATH_DEFINE_METHOD_FUNC (polyline, -1)
+RB_COGL_PATH_DEFINE_METHOD_FUNC (polygon, -1)
+
+#define RB_COGL_PATH_DEFINE_METHOD(name)                                \
+  rb_define_method (klass, G_STRINGIFY (name), rb_cogl_path_m_ ## name, -1)
+
+static VALUE
+rb_cogl_path_m_fill (VALUE self)
+{
+  CoglHandle old_path = cogl_handle_ref (cogl_get_path ());
+
+  /* Use the preserve variant so that the path isn't replaced and
+     can be filled again on the next frame */
+  cogl_set_path (rb_cogl_handle_get_handle (self));
+  cogl_path_fill_preserve ();
+  cogl_set_path (old_path);
+  cogl_handle_unref (old_path);
+
+  return self;
+}
+
+static VALUE
+rb_cogl_path_m_stroke (VALUE self)
+{
+  CoglHandle old_path = cogl_handle_ref (cogl_get_path ());
+
+  cogl_set_path (rb_cogl_handle_get_handle (self));
+  cogl_path_stroke_preserve ();
+  cogl_set_path (old_path);
+  cogl_handle_unref (old_path);
+
+  return self;
 }
 
 static void
@@ -336,6 +539,26 @@ rb_cogl_path_init ()
 {
   VALUE klass = rb_cogl_define_handle (cogl_is_path, "Path");
   rb_define_method(klass, "dup", rb_cogl_path_dup, 0);
+
+  rb_define_method (klass, "initialize", rb_cogl_path_initialize, 0);
+
+  RB_COGL_PATH_DEFINE_METHOD (move_to);
+  RB_COGL_PATH_DEFINE_METHOD (rel_move_to);
+  RB_COGL_PATH_DEFINE_METHOD (line_to);
+  RB_COGL_PATH_DEFINE_METHOD (rel_line_to);
+  RB_COGL_PATH_DEFINE_METHOD (arc);
+  RB_COGL_PATH_DEFINE_METHOD (curve_to);
+  RB_COGL_PATH_DEFINE_METHOD (rel_curve_to);
+  RB_COGL_PATH_DEFINE_METHOD (close);
+  RB_COGL_PATH_DEFINE_METHOD (line);
+  RB_COGL_PATH_DEFINE_METHOD (rectangle);
+  RB_COGL_PATH_DEFINE_METHOD (ellipse);
+  RB_COGL_PATH_DEFINE_METHOD (round_rectangle);
+  RB_COGL_PATH_DEFINE_METHOD (polyline);
+  RB_COGL_PATH_DEFINE_METHOD (polygon);
+
+  rb_define_method (klass, "fill", rb_cogl_path_m_fill, 0);
+  rb_define_method (klass, "stroke", rb_cogl_path_m_stroke, 0);
 }
 
 void
@@ -22,8 +22,18 @@
 #include <cogl/cogl.h>
 
 #include "rbclutter.h"
+#include "rbcoglattributearray.h"
 
 VALUE rb_c_cogl_vec3 = Qnil;
+VALUE rb_c_cogl_vec3_array = Qnil;
+
+typedef struct _RBCoglVector3Array RBCoglVector3Array;
+
+struct _RBCoglVector3Array
+{
+  guint length;
+  CoglVector3 *vectors;
+};
 
 /* Welcome to your accessor */
 static CoglVector3 *
@@ -185,6 +195,384 @@ rb_cogl_vector3_distance (VALUE self, VALUE other)
   return DBL2NUM (cogl_vector3_distance (vec3_ptr (self), vec3_ptr (other)));
 }
 
+/* In-place variants of the above. These modify the receiver and
+   return it instead of allocating a new vector */
+
+static VALUE
+rb_cogl_vector3_invert_bang (VALUE self)
+{
+  cogl_vector3_invert (vec3_ptr (self));
+  return self;
+}
+
+static VALUE
+rb_cogl_vector3_add_bang (VALUE self, VALUE other)
+{
+  CoglVector3 tmp = *vec3_ptr (self);
+
+  cogl_vector3_add (vec3_ptr (self), &tmp, vec3_ptr (other));
+  return self;
+}
+
+static VALUE
+rb_cogl_vector3_subtract_bang (VALUE self, VALUE other)
+{
+  CoglVector3 tmp = *vec3_ptr (self);
+
+  cogl_vector3_subtract (vec3_ptr (self), &tmp, vec3_ptr (other));
+  return self;
+}
+
+static VALUE
+rb_cogl_vector3_multiply_scalar_bang (VALUE self, VALUE other)
+{
+  cogl_vector3_multiply_scalar (vec3_ptr (self), NUM2DBL (other));
+  return self;
+}
+
+static VALUE
+rb_cogl_vector3_divide_scalar_bang (VALUE self, VALUE other)
+{
+  cogl_vector3_divide_scalar (vec3_ptr (self), NUM2DBL (other));
+  return self;
+}
+
+static VALUE
+rb_cogl_vector3_normalize_bang (VALUE self)
+{
+  cogl_vector3_normalize (vec3_ptr (self));
+  return self;
+}
+
+static VALUE
+rb_cogl_vector3_cross_product_bang (VALUE self, VALUE other)
+{
+  CoglVector3 tmp = *vec3_ptr (self);
+
+  cogl_vector3_cross_product (vec3_ptr (self), &tmp, vec3_ptr (other));
+  return self;
+}
+
+static VALUE
+rb_cogl_vector3_set (VALUE self, VALUE vx, VALUE vy, VALUE vz)
+{
+  cogl_vector3_init (vec3_ptr (self), NUM2DBL (vx), NUM2DBL (vy),
+                     NUM2DBL (vz));
+  return self;
+}
+
+/* Vector3Array stores a packed array of vectors so that operations
+   can be applied to all of them without a Ruby object per vector */
+
+static void
+rb_cogl_vector3_array_free (void *inst)
+{
+  RBCoglVector3Array *array = inst;
+
+  g_free (array->vectors);
+  g_slice_free (RBCoglVector3Array, array);
+}
+
+static VALUE
+rb_cogl_vector3_array_alloc (VALUE klass)
+{
+  RBCoglVector3Array *array = g_slice_new (RBCoglVector3Array);
+
+  array->length = 0;
+  array->vectors = NULL;
+
+  return Data_Wrap_Struct (klass, 0, rb_cogl_vector3_array_free, array);
+}
+
+static RBCoglVector3Array *
+vec3_array_ptr (VALUE self)
+{
+  RBCoglVector3Array *array;
+
+  if (TYPE (self) != T_DATA
+      || RDATA (self)->dfree != rb_cogl_vector3_array_free)
+    rb_raise (rb_eTypeError, "wrong argument type");
+
+  Data_Get_Struct (self, RBCoglVector3Array, array);
+  return array;
+}
+
+static VALUE
+rb_cogl_vector3_array_new_bare (guint length)
+{
+  VALUE result = rb_cogl_vector3_array_alloc (rb_c_cogl_vec3_array);
+  RBCoglVector3Array *array = vec3_array_ptr (result);
+
+  array->length = length;
+  array->vectors = g_new0 (CoglVector3, length);
+  return result;
+}
+
+static CoglVector3 *
+vec3_array_index (RBCoglVector3Array *array, VALUE index_value)
+{
+  int index_num = NUM2INT (index_value);
+
+  if (index_num < 0 || index_num >= array->length)
+    rb_raise (rb_eArgError, "index out of range");
+
+  return array->vectors + index_num;
+}
+
+/* The other operand of a batched operation can either be a single
+   Vector3 which is used for every element or another array of the
+   same length. Returns the step to advance the other pointer by */
+static const CoglVector3 *
+vec3_array_operand (RBCoglVector3Array *array, VALUE other, int *step)
+{
+  if (RTEST (rb_obj_is_kind_of (other, rb_c_cogl_vec3)))
+    {
+      *step = 0;
+      return vec3_ptr (other);
+    }
+  else
+    {
+      RBCoglVector3Array *other_array = vec3_array_ptr (other);
+
+      if (other_array->length != array->length)
+        rb_raise (rb_eArgError, "the arrays are not the same length");
+
+      *step = 1;
+      return other_array->vectors;
+    }
+}
+
+static VALUE
+rb_cogl_vector3_array_initialize (VALUE self, VALUE length)
+{
+  RBCoglVector3Array *array = vec3_array_ptr (self);
+
+  g_free (array->vectors);
+  array->length = NUM2UINT (length);
+  array->vectors = g_new0 (CoglVector3, array->length);
+  return self;
+}
+
+static VALUE
+rb_cogl_vector3_array_initialize_copy (VALUE self, VALUE orig)
+{
+  RBCoglVector3Array *array = vec3_array_ptr (self);
+  RBCoglVector3Array *orig_array = vec3_array_ptr (orig);
+
+  g_free (array->vectors);
+  array->length = orig_array->length;
+  array->vectors = g_memdup (orig_array->vectors,
+                             sizeof (CoglVector3) * orig_array->length);
+  return self;
+}
+
+static VALUE
+rb_cogl_vector3_array_length (VALUE self)
+{
+  return UINT2NUM (vec3_array_ptr (self)->length);
+}
+
+static VALUE
+rb_cogl_vector3_array_aref (VALUE self, VALUE index_value)
+{
+  VALUE result = rb_cogl_vector3_alloc_bare ();
+
+  *vec3_ptr (result) = *vec3_array_index (vec3_array_ptr (self), index_value);
+  return result;
+}
+
+static VALUE
+rb_cogl_vector3_array_aset (VALUE self, VALUE index_value, VALUE v)
+{
+  *vec3_array_index (vec3_array_ptr (self), index_value) = *vec3_ptr (v);
+  return v;
+}
+
+static VALUE
+rb_cogl_vector3_array_set (VALUE self, VALUE index_value,
+                           VALUE vx, VALUE vy, VALUE vz)
+{
+  cogl_vector3_init (vec3_array_index (vec3_array_ptr (self), index_value),
+                     NUM2DBL (vx), NUM2DBL (vy), NUM2DBL (vz));
+  return self;
+}
+
+static VALUE
+rb_cogl_vector3_array_add_bang (VALUE self, VALUE other)
+{
+  RBCoglVector3Array *array = vec3_array_ptr (self);
+  int step;
+  const CoglVector3 *o = vec3_array_operand (array, other, &step);
+  CoglVector3 *v = array->vectors;
+  guint i;
+
+  for (i = 0; i < array->length; i++, v++, o += step)
+    {
+      v->x += o->x;
+      v->y += o->y;
+      v->z += o->z;
+    }
+
+  return self;
+}
+
+static VALUE
+rb_cogl_vector3_array_subtract_bang (VALUE self, VALUE other)
+{
+  RBCoglVector3Array *array = vec3_array_ptr (self);
+  int step;
+  const CoglVector3 *o = vec3_array_operand (array, other, &step);
+  CoglVector3 *v = array->vectors;
+  guint i;
+
+  for (i = 0; i < array->length; i++, v++, o += step)
+    {
+      v->x -= o->x;
+      v->y -= o->y;
+      v->z -= o->z;
+    }
+
+  return self;
+}
+
+static VALUE
+rb_cogl_vector3_array_multiply_scalar_bang (VALUE self, VALUE scalar)
+{
+  RBCoglVector3Array *array = vec3_array_ptr (self);
+  float s = NUM2DBL (scalar);
+  guint i;
+
+  for (i = 0; i < array->length; i++)
+    cogl_vector3_multiply_scalar (array->vectors + i, s);
+
+  return self;
+}
+
+static VALUE
+rb_cogl_vector3_array_normalize_bang (VALUE self)
+{
+  RBCoglVector3Array *array = vec3_array_ptr (self);
+  guint i;
+
+  for (i = 0; i < array->length; i++)
+    cogl_vector3_normalize (array->vectors + i);
+
+  return self;
+}
+
+static VALUE
+rb_cogl_vector3_array_cross_product_bang (VALUE self, VALUE other)
+{
+  RBCoglVector3Array *array = vec3_array_ptr (self);
+  int step;
+  const CoglVector3 *o = vec3_array_operand (array, other, &step);
+  CoglVector3 tmp;
+  guint i;
+
+  for (i = 0; i < array->length; i++, o += step)
+    {
+      tmp = array->vectors[i];
+      cogl_vector3_cross_product (array->vectors + i, &tmp, o);
+    }
+
+  return self;
+}
+
+static VALUE
+rb_cogl_vector3_array_dot_products (VALUE self, VALUE other)
+{
+  RBCoglVector3Array *array = vec3_array_ptr (self);
+  int step;
+  const CoglVector3 *o = vec3_array_operand (array, other, &step);
+  VALUE result = rb_cogl_attribute_array_new (COGL_ATTRIBUTE_TYPE_FLOAT,
+                                              array->length);
+  float *dots = rb_cogl_attribute_array_get_pointer (result)->data;
+  guint i;
+
+  for (i = 0; i < array->length; i++, o += step)
+    dots[i] = cogl_vector3_dot_product (array->vectors + i, o);
+
+  return result;
+}
+
+static VALUE
+rb_cogl_vector3_array_magnitudes (VALUE self)
+{
+  RBCoglVector3Array *array = vec3_array_ptr (self);
+  VALUE result = rb_cogl_attribute_array_new (COGL_ATTRIBUTE_TYPE_FLOAT,
+                                              array->length);
+  float *magnitudes = rb_cogl_attribute_array_get_pointer (result)->data;
+  guint i;
+
+  for (i = 0; i < array->length; i++)
+    magnitudes[i] = cogl_vector3_magnitude (array->vectors + i);
+
+  return result;
+}
+
+static VALUE
+rb_cogl_vector3_array_to_s (VALUE self)
+{
+  RBCoglVector3Array *array = vec3_array_ptr (self);
+
+  return rb_str_new ((const char *) array->vectors,
+                     sizeof (CoglVector3) * array->length);
+}
+
+static VALUE
+rb_cogl_vector3_array_to_a (VALUE self)
+{
+  RBCoglVector3Array *array = vec3_array_ptr (self);
+  VALUE result = rb_ary_new2 (array->length);
+  guint i;
+
+  for (i = 0; i < array->length; i++)
+    {
+      VALUE v = rb_cogl_vector3_alloc_bare ();
+
+      *vec3_ptr (v) = array->vectors[i];
+      rb_ary_push (result, v);
+    }
+
+  return result;
+}
+
+static void
+rb_cogl_vector3_array_init ()
+{
+  VALUE klass;
+
+  klass = rb_define_class_under (rbclt_c_cogl, "Vector3Array", rb_cObject);
+  rb_define_alloc_func (klass, rb_cogl_vector3_array_alloc);
+
+  rb_define_method (klass, "initialize", rb_cogl_vector3_array_initialize, 1);
+  rb_define_method (klass, "initialize_copy",
+                    rb_cogl_vector3_array_initialize_copy, 1);
+  rb_define_method (klass, "length", rb_cogl_vector3_array_length, 0);
+  rb_define_alias (klass, "size", "length");
+  rb_define_method (klass, "[]", rb_cogl_vector3_array_aref, 1);
+  rb_define_method (klass, "[]=", rb_cogl_vector3_array_aset, 2);
+  rb_define_method (klass, "set", rb_cogl_vector3_array_set, 4);
+
+  rb_define_method (klass, "add!", rb_cogl_vector3_array_add_bang, 1);
+  rb_define_method (klass, "subtract!",
+                    rb_cogl_vector3_array_subtract_bang, 1);
+  rb_define_method (klass, "multiply_scalar!",
+                    rb_cogl_vector3_array_multiply_scalar_bang, 1);
+  rb_define_method (klass, "normalize!",
+                    rb_cogl_vector3_array_normalize_bang, 0);
+  rb_define_method (klass, "cross_product!",
+                    rb_cogl_vector3_array_cross_product_bang, 1);
+  rb_define_method (klass, "dot_products",
+                    rb_cogl_vector3_array_dot_products, 1);
+  rb_define_method (klass, "magnitudes", rb_cogl_vector3_array_magnitudes, 0);
+
+  rb_define_method (klass, "to_a", rb_cogl_vector3_array_to_a, 0);
+  rb_define_method (klass, "to_s", rb_cogl_vector3_array_to_s, 0);
+
+  rb_c_cogl_vec3_array = klass;
+}
+
 void rb_cogl_vector3_init ()
 {
   VALUE klass;
@@ -209,6 +597,18 @@ void rb_cogl_vector3_init ()
   rb_define_method (klass, "dot_product", rb_cogl_vector3_dot_product, 1);
   rb_define_method (klass, "distance", rb_cogl_vector3_distance, 1);
 
+  rb_define_method (klass, "set", rb_cogl_vector3_set, 3);
+  rb_define_method (klass, "invert!", rb_cogl_vector3_invert_bang, 0);
+  rb_define_method (klass, "add!", rb_cogl_vector3_add_bang, 1);
+  rb_define_method (klass, "subtract!", rb_cogl_vector3_subtract_bang, 1);
+  rb_define_method (klass, "multiply_scalar!",
+                    rb_cogl_vector3_multiply_scalar_bang, 1);
+  rb_define_method (klass, "divide_scalar!",
+                    rb_cogl_vector3_divide_scalar_bang, 1);
+  rb_define_method (klass, "normalize!", rb_cogl_vector3_normalize_bang, 0);
+  rb_define_method (klass, "cross_product!",
+                    rb_cogl_vector3_cross_product_bang, 1);
+
   rb_define_alias (klass, "+",  "add");
   rb_define_alias (klass, "-",  "subtract");
   rb_define_alias (klass, "-@", "invert");
@@ -220,4 +620,6 @@ void rb_cogl_vector3_init ()
   rb_define_alias (klass, "to_s", "inspect");
 
   rb_c_cogl_vec3 = klass;
+
+  rb_cogl_vector3_array_init ();
 }
\ No newline at end of file
@@ -26,14 +26,34 @@
 #include "rbcoglcolor.h"
 #include "rbcogltexture.h"
 #include "rbcoglmatrix.h"
+#include "rbcoglattributearray.h"
+#include "rbcoglvertexlayout.h"
 
 static VALUE rb_c_cogl_vertex_buffer_indices;
+static VALUE rb_c_cogl_vertex_buffer_batch;
 static ID id_to_add_array;
 static ID id_to_delete_array;
+static ID id_retained_hash;
 static ID id_pack;
 
 #define N_VERTEX_ATTRIBUTE_ARGS 7
 
+typedef struct
+{
+  VALUE vertex_buffer;
+  VALUE indices;
+  VALUE material;
+  /* The handles are looked up when the record is added so that
+     drawing doesn't need to convert the Ruby objects again */
+  CoglHandle vertex_buffer_handle;
+  CoglHandle indices_handle;
+  CoglHandle material_handle;
+  CoglVerticesMode mode;
+  guint first;
+  guint count;
+  guint n_vertices;
+} BatchRecord;
+
 static VALUE
 rb_cogl_vertex_buffer_initialize (VALUE self, VALUE n_vertices)
 {
@@ -59,6 +79,7 @@ rb_cogl_vertex_buffer_add (int argc, VALUE *argv, VALUE self)
   VALUE value_array;
   VALUE to_add_array;
   VALUE to_delete_array;
+  VALUE retained_hash;
 
   /* We will collect all of the arguments into an array and store them
      in an array of attributes to add when submit is called */
@@ -68,6 +89,21 @@ rb_cogl_vertex_buffer_add (int argc, VALUE *argv, VALUE self)
 
   value_array = rb_ary_new4 (N_VERTEX_ATTRIBUTE_ARGS, values);
 
+  /* Attributes backed by an attribute array are remembered so that
+     they can be partially modified later with update */
+  retained_hash = rb_ivar_get (self, id_retained_hash);
+  if (rb_cogl_is_kind_of_attribute_array (values[5]))
+    {
+      StringValue (values[0]);
+
+      if (TYPE (retained_hash) != T_HASH)
+        rb_ivar_set (self, id_retained_hash, retained_hash = rb_hash_new ());
+
+      rb_hash_aset (retained_hash, values[0], value_array);
+    }
+  else if (TYPE (retained_hash) == T_HASH)
+    rb_hash_delete (retained_hash, values[0]);
+
   if (TYPE (to_add_array = rb_ivar_get (self, id_to_add_array)) != T_ARRAY)
     rb_ivar_set (self, id_to_add_array, to_add_array = rb_ary_new ());
 
@@ -82,10 +118,43 @@ rb_cogl_vertex_buffer_add (int argc, VALUE *argv, VALUE self)
   return self;
 }
 
+static VALUE
+rb_cogl_vertex_buffer_add_layout (VALUE self, VALUE layout_arg)
+{
+  RBCoglVertexLayout *layout;
+  VALUE values[N_VERTEX_ATTRIBUTE_ARGS];
+  guint i;
+
+  rb_cogl_assert_is_kind_of_vertex_layout (layout_arg);
+  layout = rb_cogl_vertex_layout_get_pointer (layout_arg);
+
+  /* Queue each attribute of the layout as if it was added separately
+     with the layout as the data, the layout's stride and the
+     attribute's offset */
+  for (i = 0; i < layout->attributes->len; i++)
+    {
+      RBCoglVertexLayoutAttribute *attribute
+        = &g_array_index (layout->attributes, RBCoglVertexLayoutAttribute, i);
+
+      values[0] = rb_str_new2 (attribute->name);
+      values[1] = UINT2NUM (attribute->n_components);
+      values[2] = GENUM2RVAL (attribute->type, COGL_TYPE_ATTRIBUTE_TYPE);
+      values[3] = attribute->normalized ? Qtrue : Qfalse;
+      values[4] = UINT2NUM (layout->stride);
+      values[5] = layout_arg;
+      values[6] = UINT2NUM (attribute->offset);
+
+      rb_cogl_vertex_buffer_add (N_VERTEX_ATTRIBUTE_ARGS, values, self);
+    }
+
+  return self;
+}
+
 static VALUE
 rb_cogl_vertex_buffer_delete (VALUE self, VALUE attribute_name)
 {
   VALUE to_delete_array;
+  VALUE retained_hash;
 
   /* We will collect the list of attributes to delete into an array */
   to_delete_array = rb_ivar_get (self, id_to_delete_array);
@@ -94,6 +163,10 @@ rb_cogl_vertex_buffer_delete (VALUE self, VALUE attribute_name)
 
   rb_ary_push (to_delete_array, attribute_name);
 
+  retained_hash = rb_ivar_get (self, id_retained_hash);
+  if (TYPE (retained_hash) == T_HASH)
+    rb_hash_delete (retained_hash, attribute_name);
+
   /* We don't need to remove the attribute from the array of
      attributes to add because the deletions are done afterwards so it
      will just work out */
@@ -112,35 +185,13 @@ typedef struct
   guint offset;
 } AddData;
 
-static int
-attribute_type_size (CoglAttributeType type)
-{
-  switch (type)
-    {
-    case COGL_ATTRIBUTE_TYPE_BYTE:
-    case COGL_ATTRIBUTE_TYPE_UNSIGNED_BYTE:
-      return sizeof (guint8);
-
-    case COGL_ATTRIBUTE_TYPE_SHORT:
-    case COGL_ATTRIBUTE_TYPE_UNSIGNED_SHORT:
-      return sizeof (guint16);
-
-    case COGL_ATTRIBUTE_TYPE_FLOAT:
-      return sizeof (gfloat);
-    }
-
-  rb_raise (rb_eRuntimeError, "Invalid CoglAttributeType");
-
-  return 1;
-}
-
 static VALUE
 convert_to_string (VALUE arg,
                    CoglAttributeType type,
                    guint8 n_components,
                    int stride)
 {
-  int type_size = attribute_type_size (type);
+  int type_size = rb_cogl_attribute_type_size (type);
   VALUE str;
 
   /* We can accept an array or something that can be converted into a
@@ -192,6 +243,37 @@ convert_to_string (VALUE arg,
   return str;
 }
 
+/* Returns the packed data for an attribute and its length in
+   bytes. This must not call back into Ruby */
+static const char *
+add_data_get_pointer (const AddData *add_data, long *length)
+{
+  if (rb_cogl_is_kind_of_attribute_array (add_data->data))
+    {
+      RBCoglAttributeArray *array
+        = rb_cogl_attribute_array_get_pointer (add_data->data);
+
+      *length = array->length * rb_cogl_attribute_type_size (array->type);
+
+      return array->data;
+    }
+  else if (rb_cogl_is_kind_of_vertex_layout (add_data->data))
+    {
+      RBCoglVertexLayout *layout
+        = rb_cogl_vertex_layout_get_pointer (add_data->data);
+
+      *length = layout->n_vertices * layout->stride;
+
+      return (const char *) rb_cogl_vertex_layout_get_data (layout);
+    }
+  else
+    {
+      *length = RSTRING_LEN (add_data->data);
+
+      return RSTRING_PTR (add_data->data);
+    }
+}
+
 static VALUE
 rb_cogl_vertex_buffer_submit (VALUE self)
 {
@@ -234,10 +316,29 @@ rb_cogl_vertex_buffer_submit (VALUE self)
                                          COGL_TYPE_ATTRIBUTE_TYPE);
           add_data[i].normalized = RTEST (entry_values[3]);
           add_data[i].stride = rbclt_num_to_guint16 (entry_values[4]);
-          add_data[i].data = convert_to_string (entry_values[5],
-                                                add_data[i].type,
-                                                add_data[i].n_components,
-                                                add_data[i].stride);
+          /* Attribute arrays are used directly without converting
+             to a string */
+          if (rb_cogl_is_kind_of_attribute_array (entry_values[5]))
+            {
+              RBCoglAttributeArray *array
+                = rb_cogl_attribute_array_get_pointer (entry_values[5]);
+
+              if (array->type != add_data[i].type)
+                rb_raise (rb_eArgError, "Attribute array type does not "
+                          "match the type for %s",
+                          StringValuePtr (add_data[i].attribute_name));
+
+              add_data[i].data = entry_values[5];
+            }
+          /* Layouts contain interleaved data of mixed types so the
+             type can't be checked */
+          else if (rb_cogl_is_kind_of_vertex_layout (entry_values[5]))
+            add_data[i].data = entry_values[5];
+          else
+            add_data[i].data = convert_to_string (entry_values[5],
+                                                  add_data[i].type,
+                                                  add_data[i].n_components,
+                                                  add_data[i].stride);
           add_data[i].offset = (NIL_P (entry_values[6]) ? 0
                                 : NUM2UINT (entry_values[6]));
         }
@@ -277,7 +378,10 @@ rb_cogl_vertex_buffer_submit (VALUE self)
   /* Verify that all of the strings are big enough */
   for (i = 0; i < n_to_add; i++)
     {
-      int type_size = attribute_type_size (add_data[i].type);
+      int type_size = rb_cogl_attribute_type_size (add_data[i].type);
+      long data_length;
+
+      add_data_get_pointer (add_data + i, &data_length);
 
       if (add_data[i].stride == 0)
         add_data[i].stride = add_data[i].n_components * type_size;
@@ -286,7 +390,7 @@ rb_cogl_vertex_buffer_submit (VALUE self)
                   StringValuePtr (add_data[i].attribute_name));
 
       if (n_verts > 0
-          && (RSTRING_LEN (add_data[i].data) - add_data[i].offset
+          && (data_length - add_data[i].offset
               < (add_data[i].stride * (n_verts - 1)
                  + add_data[i].n_components * type_size)))
         rb_raise (rb_eArgError, "Data is too short for %s",
@@ -297,14 +401,18 @@ rb_cogl_vertex_buffer_submit (VALUE self)
      error or call back into Ruby past this point */
 
   for (i = 0; i < n_to_add; i++)
-    cogl_vertex_buffer_add (vertex_buffer,
-                            StringValuePtr (add_data[i].attribute_name),
-                            add_data[i].n_components,
-                            add_data[i].type,
-                            add_data[i].normalized,
-                            add_data[i].stride,
-                            StringValuePtr (add_data[i].data)
-                            + add_data[i].offset);
+    {
+      long data_length;
+      const char *data = add_data_get_pointer (add_data + i, &data_length);
+
+      cogl_vertex_buffer_add (vertex_buffer,
+                              StringValuePtr (add_data[i].attribute_name),
+                              add_data[i].n_components,
+                              add_data[i].type,
+                              add_data[i].normalized,
+                              add_data[i].stride,
+                              data + add_data[i].offset);
+    }
 
   for (i = 0; i < n_to_delete; i++)
     cogl_vertex_buffer_delete (vertex_buffer,
@@ -315,6 +423,123 @@ rb_cogl_vertex_buffer_submit (VALUE self)
   return self;
 }
 
+static VALUE
+rb_cogl_vertex_buffer_update (VALUE self,
+                              VALUE attribute_name,
+                              VALUE first_arg,
+                              VALUE count_arg,
+                              VALUE data)
+{
+  CoglHandle vertex_buffer = rb_cogl_handle_get_handle (self);
+  guint n_verts = cogl_vertex_buffer_get_n_vertices (vertex_buffer);
+  guint first = NUM2UINT (first_arg), count = NUM2UINT (count_arg);
+  VALUE retained_hash, entry, to_add_array;
+  RBCoglAttributeArray *array;
+  CoglAttributeType type;
+  guint n_components, stride, offset, v, c;
+  int type_size;
+  long i;
+
+  retained_hash = rb_ivar_get (self, id_retained_hash);
+  if (TYPE (retained_hash) != T_HASH
+      || NIL_P (entry = rb_hash_lookup (retained_hash, attribute_name)))
+    rb_raise (rb_eArgError, "%s was not added with an attribute array",
+              StringValuePtr (attribute_name));
+
+  array = rb_cogl_attribute_array_get_pointer (RARRAY_PTR (entry)[5]);
+  n_components = rbclt_num_to_guint8 (RARRAY_PTR (entry)[1]);
+  type = RVAL2GENUM (RARRAY_PTR (entry)[2], COGL_TYPE_ATTRIBUTE_TYPE);
+  stride = rbclt_num_to_guint16 (RARRAY_PTR (entry)[4]);
+  offset = NIL_P (RARRAY_PTR (entry)[6]) ? 0 : NUM2UINT (RARRAY_PTR (entry)[6]);
+  type_size = rb_cogl_attribute_type_size (type);
+
+  if (type != array->type)
+    rb_raise (rb_eArgError, "Attribute array type does not match the "
+              "type for %s", StringValuePtr (attribute_name));
+
+  /* Work in elements rather than bytes from here on */
+  if (stride == 0)
+    stride = n_components * type_size;
+  if (stride % type_size || offset % type_size)
+    rb_raise (rb_eArgError, "The stride and offset for %s are not a "
+              "multiple of the element size",
+              StringValuePtr (attribute_name));
+  stride /= type_size;
+  offset /= type_size;
+
+  if (first > n_verts || count > n_verts - first)
+    rb_raise (rb_eArgError, "The vertex range is out of bounds");
+  if (count > 0
+      && offset + (first + count - 1) * stride + n_components > array->length)
+    rb_raise (rb_eArgError, "Data is too short for %s",
+              StringValuePtr (attribute_name));
+
+  if (TYPE (data) == T_ARRAY)
+    {
+      if (RARRAY_LEN (data) != count * n_components)
+        rb_raise (rb_eArgError, "Expected %u values", count * n_components);
+
+      /* Converting the values may call back into Ruby so the length
+         of the source array is checked again on each iteration */
+      for (v = 0, i = 0; v < count; v++)
+        for (c = 0; c < n_components && i < RARRAY_LEN (data); c++, i++)
+          rb_cogl_attribute_array_store (array,
+                                         offset + (first + v) * stride + c,
+                                         RARRAY_PTR (data)[i]);
+    }
+  else
+    {
+      const guint8 *src;
+      long length;
+
+      if (rb_cogl_is_kind_of_attribute_array (data))
+        {
+          RBCoglAttributeArray *other
+            = rb_cogl_attribute_array_get_pointer (data);
+
+          if (other->type != array->type)
+            rb_raise (rb_eArgError, "attribute array types do not match");
+
+          src = other->data;
+          length = other->length * type_size;
+        }
+      else
+        {
+          StringValue (data);
+          src = (const guint8 *) RSTRING_PTR (data);
+          length = RSTRING_LEN (data);
+        }
+
+      if (length != count * n_components * type_size)
+        rb_raise (rb_eArgError, "Expected %u bytes",
+                  count * n_components * type_size);
+
+      if (stride == n_components)
+        memcpy ((guint8 *) array->data + (offset + first * stride) * type_size,
+                src, length);
+      else
+        for (v = 0; v < count; v++)
+          memcpy ((guint8 *) array->data
+                  + (offset + (first + v) * stride) * type_size,
+                  src + v * n_components * type_size,
+                  n_components * type_size);
+    }
+
+  /* Queue the attribute to be added again on the next submit unless
+     it is already pending. Attributes that haven't been touched
+     aren't re-added so Cogl won't upload them again */
+  if (TYPE (to_add_array = rb_ivar_get (self, id_to_add_array)) != T_ARRAY)
+    rb_ivar_set (self, id_to_add_array, to_add_array = rb_ary_new ());
+
+  for (i = 0; i < RARRAY_LEN (to_add_array); i++)
+    if (RARRAY_PTR (to_add_array)[i] == entry)
+      break;
+  if (i >= RARRAY_LEN (to_add_array))
+    rb_ary_push (to_add_array, entry);
+
+  return self;
+}
+
 static VALUE
 rb_cogl_vertex_buffer_enable (VALUE self, VALUE attribute_name)
 {
@@ -490,6 +715,181 @@ rb_cogl_vertex_buffer_draw_elements (VALUE self,
   return self;
 }
 
+static void
+rb_cogl_vertex_buffer_batch_mark (void *data)
+{
+  GArray *records = data;
+  guint i;
+
+  for (i = 0; i < records->len; i++)
+    {
+      BatchRecord *record = &g_array_index (records, BatchRecord, i);
+
+      rb_gc_mark (record->vertex_buffer);
+      rb_gc_mark (record->indices);
+      rb_gc_mark (record->material);
+    }
+}
+
+static void
+rb_cogl_vertex_buffer_batch_free (void *data)
+{
+  g_array_free (data, TRUE);
+}
+
+static VALUE
+rb_cogl_vertex_buffer_batch_alloc (VALUE klass)
+{
+  GArray *records = g_array_new (FALSE, FALSE, sizeof (BatchRecord));
+
+  return Data_Wrap_Struct (klass, rb_cogl_vertex_buffer_batch_mark,
+                           rb_cogl_vertex_buffer_batch_free, records);
+}
+
+static GArray *
+rb_cogl_vertex_buffer_batch_get_records (VALUE self)
+{
+  GArray *records;
+
+  if (TYPE (self) != T_DATA
+      || RDATA (self)->dfree != rb_cogl_vertex_buffer_batch_free)
+    rb_raise (rb_eTypeError, "wrong argument type");
+
+  Data_Get_Struct (self, GArray, records);
+
+  return records;
+}
+
+static VALUE
+rb_cogl_vertex_buffer_batch_add (int argc, VALUE *argv, VALUE self)
+{
+  GArray *records = rb_cogl_vertex_buffer_batch_get_records (self);
+  VALUE vertex_buffer, mode, first_arg, count_arg, indices, material;
+  BatchRecord record;
+
+  rb_scan_args (argc, argv, "24", &vertex_buffer, &mode, &first_arg,
+                &count_arg, &indices, &material);
+
+  record.vertex_buffer = vertex_buffer;
+  record.vertex_buffer_handle = rb_cogl_handle_get_handle (vertex_buffer);
+  if (!cogl_is_vertex_buffer (record.vertex_buffer_handle))
+    rb_raise (rb_eTypeError, "wrong argument type");
+  record.n_vertices
+    = cogl_vertex_buffer_get_n_vertices (record.vertex_buffer_handle);
+  record.mode = RVAL2GENUM (mode, COGL_TYPE_VERTICES_MODE);
+  record.indices = indices;
+  record.indices_handle = (NIL_P (indices) ? COGL_INVALID_HANDLE
+                           : rb_cogl_handle_get_handle (indices));
+  record.material = material;
+  record.material_handle = (NIL_P (material) ? COGL_INVALID_HANDLE
+                            : rb_cogl_handle_get_handle (material));
+  record.first = NIL_P (first_arg) ? 0 : NUM2UINT (first_arg);
+
+  if (record.indices_handle == COGL_INVALID_HANDLE)
+    {
+      /* Validate the range the same way as VertexBuffer#draw */
+      if (record.first >= record.n_vertices)
+        rb_raise (rb_eArgError, "The 'first' argument is too high (%u >= %u)",
+                  record.first, record.n_vertices);
+
+      if (NIL_P (count_arg))
+        record.count = record.n_vertices - record.first;
+      else
+        record.count = NUM2UINT (count_arg);
+
+      if (record.count + record.first > record.n_vertices)
+        rb_raise (rb_eArgError, "The 'count' argument is too large (%u > %u)",
+                  record.count, record.n_vertices - record.first);
+    }
+  else
+    {
+      /* For indexed records the first and count refer to the indices
+         which we can't validate */
+      if (NIL_P (count_arg))
+        rb_raise (rb_eArgError, "A count is required when drawing indices");
+
+      record.count = NUM2UINT (count_arg);
+    }
+
+  g_array_append_val (records, record);
+
+  return self;
+}
+
+static VALUE
+rb_cogl_vertex_buffer_batch_clear (VALUE self)
+{
+  GArray *records = rb_cogl_vertex_buffer_batch_get_records (self);
+
+  g_array_set_size (records, 0);
+
+  return self;
+}
+
+static VALUE
+rb_cogl_vertex_buffer_batch_get_size (VALUE self)
+{
+  GArray *records = rb_cogl_vertex_buffer_batch_get_records (self);
+
+  return UINT2NUM (records->len);
+}
+
+static VALUE
+rb_cogl_vertex_buffer_batch_draw (VALUE self)
+{
+  GArray *records = rb_cogl_vertex_buffer_batch_get_records (self);
+  CoglHandle last_material = COGL_INVALID_HANDLE;
+  guint i;
+
+  /* Flush any attributes that were added from Ruby since the last
+     submit. This may call back into Ruby so it is done before
+     drawing anything */
+  for (i = 0; i < records->len; i++)
+    {
+      VALUE vertex_buffer = g_array_index (records, BatchRecord,
+                                           i).vertex_buffer;
+
+      if (!NIL_P (rb_ivar_get (vertex_buffer, id_to_add_array))
+          || !NIL_P (rb_ivar_get (vertex_buffer, id_to_delete_array)))
+        rb_cogl_vertex_buffer_submit (vertex_buffer);
+    }
+
+  for (i = 0; i < records->len; i++)
+    {
+      const BatchRecord *record = &g_array_index (records, BatchRecord, i);
+
+      if (record->material_handle != COGL_INVALID_HANDLE
+          && record->material_handle != last_material)
+        {
+          cogl_set_source (record->material_handle);
+          last_material = record->material_handle;
+        }
+
+      if (record->indices_handle == COGL_INVALID_HANDLE)
+        cogl_vertex_buffer_draw (record->vertex_buffer_handle,
+                                 record->mode,
+                                 record->first,
+                                 record->count);
+      else
+        cogl_vertex_buffer_draw_elements (record->vertex_buffer_handle,
+                                          record->mode,
+                                          record->indices_handle,
+                                          0, record->n_vertices - 1,
+                                          record->first,
+                                          record->count);
+    }
+
+  return self;
+}
+
+static VALUE
+rb_cogl_vertex_buffer_draw_batch (VALUE self, VALUE batch)
+{
+  rb_cogl_vertex_buffer_batch_draw (batch);
+
+  return self;
+}
+
 void
 rb_cogl_vertex_buffer_init ()
 {
@@ -501,19 +901,37 @@ rb_cogl_vertex_buffer_init ()
 
   id_to_add_array = rb_intern ("_prv_to_add");
   id_to_delete_array = rb_intern ("_prv_to_delete");
+  id_retained_hash = rb_intern ("_prv_retained");
   id_pack = rb_intern ("pack");
 
   rb_define_method (klass, "initialize", rb_cogl_vertex_buffer_initialize, 1);
   rb_define_method (klass, "n_vertices",
                     rb_cogl_vertex_buffer_get_n_vertices, 0);
   rb_define_method (klass, "add", rb_cogl_vertex_buffer_add, -1);
+  rb_define_method (klass, "add_layout", rb_cogl_vertex_buffer_add_layout, 1);
   rb_define_method (klass, "delete", rb_cogl_vertex_buffer_delete, 1);
+  rb_define_method (klass, "update", rb_cogl_vertex_buffer_update, 4);
   rb_define_method (klass, "submit", rb_cogl_vertex_buffer_submit, 0);
   rb_define_method (klass, "enable", rb_cogl_vertex_buffer_enable, 1);
   rb_define_method (klass, "disable", rb_cogl_vertex_buffer_disable, 1);
   rb_define_method (klass, "draw", rb_cogl_vertex_buffer_draw, -1);
   rb_define_method (klass, "draw_elements",
                     rb_cogl_vertex_buffer_draw_elements, 6);
+  rb_define_singleton_method (klass, "draw_batch",
+                              rb_cogl_vertex_buffer_draw_batch, 1);
+
+  rb_c_cogl_vertex_buffer_batch
+    = rb_define_class_under (klass, "Batch", rb_cObject);
+  rb_define_alloc_func (rb_c_cogl_vertex_buffer_batch,
+                        rb_cogl_vertex_buffer_batch_alloc);
+  rb_define_method (rb_c_cogl_vertex_buffer_batch, "add",
+                    rb_cogl_vertex_buffer_batch_add, -1);
+  rb_define_method (rb_c_cogl_vertex_buffer_batch, "clear",
+                    rb_cogl_vertex_buffer_batch_clear, 0);
+  rb_define_method (rb_c_cogl_vertex_buffer_batch, "size",
+                    rb_cogl_vertex_buffer_batch_get_size, 0);
+  rb_define_method (rb_c_cogl_vertex_buffer_batch, "draw",
+                    rb_cogl_vertex_buffer_batch_draw, 0);
 
   /* There's no cogl_is_vertex_buffer_indices function so we can't use
      rb_cogl_define_handle */
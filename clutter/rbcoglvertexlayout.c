@@ -0,0 +1,311 @@
+/* Ruby bindings for the Clutter 'interactive canvas' library.
+ * Copyright (C) 2010  Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#include <rbgobject.h>
+#include <cogl/cogl.h>
+
+#include "rbclutter.h"
+#include "rbcoglattributearray.h"
+#include "rbcoglvertexlayout.h"
+
+/* Each vertex is padded to a multiple of this many bytes */
+#define VERTEX_ALIGNMENT 4
+
+static VALUE rb_cogl_c_vertex_layout;
+
+static void
+rb_cogl_vertex_layout_free (void *data)
+{
+  RBCoglVertexLayout *layout = data;
+  guint i;
+
+  for (i = 0; i < layout->attributes->len; i++)
+    g_free (g_array_index (layout->attributes,
+                           RBCoglVertexLayoutAttribute, i).name);
+
+  g_array_free (layout->attributes, TRUE);
+  g_free (layout->data);
+  g_slice_free (RBCoglVertexLayout, layout);
+}
+
+static VALUE
+rb_cogl_vertex_layout_alloc_with_class (VALUE klass)
+{
+  RBCoglVertexLayout *layout = g_slice_new (RBCoglVertexLayout);
+
+  layout->n_vertices = 0;
+  layout->stride = 0;
+  layout->attributes = g_array_new (FALSE, FALSE,
+                                    sizeof (RBCoglVertexLayoutAttribute));
+  layout->data = NULL;
+
+  return Data_Wrap_Struct (klass, 0, rb_cogl_vertex_layout_free, layout);
+}
+
+RBCoglVertexLayout *
+rb_cogl_vertex_layout_get_pointer (VALUE self)
+{
+  RBCoglVertexLayout *layout;
+
+  Data_Get_Struct (self, RBCoglVertexLayout, layout);
+
+  return layout;
+}
+
+gboolean
+rb_cogl_is_kind_of_vertex_layout (VALUE self)
+{
+  return (TYPE (self) == T_DATA
+          && RDATA (self)->dfree == rb_cogl_vertex_layout_free);
+}
+
+void
+rb_cogl_assert_is_kind_of_vertex_layout (VALUE arg)
+{
+  if (!rb_cogl_is_kind_of_vertex_layout (arg))
+    rb_raise (rb_eTypeError, "wrong argument type");
+}
+
+guint8 *
+rb_cogl_vertex_layout_get_data (RBCoglVertexLayout *layout)
+{
+  if (layout->data == NULL)
+    layout->data = g_malloc0 (layout->n_vertices * layout->stride);
+
+  return layout->data;
+}
+
+static RBCoglVertexLayoutAttribute *
+rb_cogl_vertex_layout_find_attribute (RBCoglVertexLayout *layout,
+                                      VALUE name)
+{
+  const char *name_str = StringValuePtr (name);
+  guint i;
+
+  for (i = 0; i < layout->attributes->len; i++)
+    {
+      RBCoglVertexLayoutAttribute *attribute
+        = &g_array_index (layout->attributes, RBCoglVertexLayoutAttribute, i);
+
+      if (!strcmp (attribute->name, name_str))
+        return attribute;
+    }
+
+  rb_raise (rb_eArgError, "no attribute named %s in the layout", name_str);
+
+  return NULL;
+}
+
+static VALUE
+rb_cogl_vertex_layout_initialize (VALUE self, VALUE n_vertices)
+{
+  RBCoglVertexLayout *layout = rb_cogl_vertex_layout_get_pointer (self);
+
+  layout->n_vertices = NUM2UINT (n_vertices);
+
+  return Qnil;
+}
+
+static VALUE
+rb_cogl_vertex_layout_add (int argc, VALUE *argv, VALUE self)
+{
+  RBCoglVertexLayout *layout = rb_cogl_vertex_layout_get_pointer (self);
+  RBCoglVertexLayoutAttribute attribute;
+  VALUE name, n_components, type, normalized;
+  int type_size;
+  guint i;
+
+  rb_scan_args (argc, argv, "31", &name, &n_components, &type, &normalized);
+
+  if (layout->data)
+    rb_raise (rb_eRuntimeError, "attributes can not be added to a layout "
+              "once it contains data");
+
+  StringValue (name);
+  for (i = 0; i < layout->attributes->len; i++)
+    if (!strcmp (g_array_index (layout->attributes,
+                                RBCoglVertexLayoutAttribute, i).name,
+                 RSTRING_PTR (name)))
+      rb_raise (rb_eArgError, "the layout already has an attribute named %s",
+                RSTRING_PTR (name));
+
+  attribute.n_components = rbclt_num_to_guint8 (n_components);
+  attribute.type = RVAL2GENUM (type, COGL_TYPE_ATTRIBUTE_TYPE);
+  attribute.normalized = RTEST (normalized);
+  type_size = rb_cogl_attribute_type_size (attribute.type);
+
+  /* Find the end of the last attribute and align it to the size of
+     the new type */
+  if (layout->attributes->len > 0)
+    {
+      RBCoglVertexLayoutAttribute *last
+        = &g_array_index (layout->attributes, RBCoglVertexLayoutAttribute,
+                          layout->attributes->len - 1);
+      attribute.offset = (last->offset + last->n_components
+                          * rb_cogl_attribute_type_size (last->type));
+      attribute.offset = ((attribute.offset + type_size - 1)
+                          / type_size * type_size);
+    }
+  else
+    attribute.offset = 0;
+
+  layout->stride = attribute.offset + attribute.n_components * type_size;
+  layout->stride = ((layout->stride + VERTEX_ALIGNMENT - 1)
+                    / VERTEX_ALIGNMENT * VERTEX_ALIGNMENT);
+
+  attribute.name = g_strdup (RSTRING_PTR (name));
+  g_array_append_val (layout->attributes, attribute);
+
+  return self;
+}
+
+static VALUE
+rb_cogl_vertex_layout_get_n_vertices (VALUE self)
+{
+  RBCoglVertexLayout *layout = rb_cogl_vertex_layout_get_pointer (self);
+
+  return UINT2NUM (layout->n_vertices);
+}
+
+static VALUE
+rb_cogl_vertex_layout_get_stride (VALUE self)
+{
+  RBCoglVertexLayout *layout = rb_cogl_vertex_layout_get_pointer (self);
+
+  return UINT2NUM (layout->stride);
+}
+
+static VALUE
+rb_cogl_vertex_layout_get_offset (VALUE self, VALUE name)
+{
+  RBCoglVertexLayout *layout = rb_cogl_vertex_layout_get_pointer (self);
+
+  return UINT2NUM (rb_cogl_vertex_layout_find_attribute (layout,
+                                                         name)->offset);
+}
+
+static VALUE
+rb_cogl_vertex_layout_set (int argc, VALUE *argv, VALUE self)
+{
+  RBCoglVertexLayout *layout = rb_cogl_vertex_layout_get_pointer (self);
+  RBCoglVertexLayoutAttribute *attribute;
+  VALUE name, values, first_arg;
+  guint first, count, v, c;
+  int type_size, vertex_size;
+  guint8 *data;
+  long i;
+
+  rb_scan_args (argc, argv, "21", &name, &values, &first_arg);
+
+  attribute = rb_cogl_vertex_layout_find_attribute (layout, name);
+  first = NIL_P (first_arg) ? 0 : NUM2UINT (first_arg);
+  type_size = rb_cogl_attribute_type_size (attribute->type);
+  vertex_size = attribute->n_components * type_size;
+  data = rb_cogl_vertex_layout_get_data (layout);
+
+  if (TYPE (values) == T_ARRAY)
+    {
+      if (RARRAY_LEN (values) % attribute->n_components)
+        rb_raise (rb_eArgError, "the number of values is not a multiple "
+                  "of the number of components");
+
+      count = RARRAY_LEN (values) / attribute->n_components;
+
+      if (first > layout->n_vertices || count > layout->n_vertices - first)
+        rb_raise (rb_eArgError, "The vertex range is out of bounds");
+
+      /* Converting the values may call back into Ruby so the length
+         of the source array is checked again on each iteration */
+      for (v = 0, i = 0; v < count; v++)
+        for (c = 0; c < attribute->n_components && i < RARRAY_LEN (values);
+             c++, i++)
+          rb_cogl_attribute_value_store (attribute->type,
+                                         data + (first + v) * layout->stride
+                                         + attribute->offset + c * type_size,
+                                         RARRAY_PTR (values)[i]);
+    }
+  else
+    {
+      const guint8 *src;
+      long length;
+
+      if (rb_cogl_is_kind_of_attribute_array (values))
+        {
+          RBCoglAttributeArray *array
+            = rb_cogl_attribute_array_get_pointer (values);
+
+          if (array->type != attribute->type)
+            rb_raise (rb_eArgError, "Attribute array type does not match "
+                      "the type for %s", attribute->name);
+
+          src = array->data;
+          length = array->length * type_size;
+        }
+      else
+        {
+          StringValue (values);
+          src = (const guint8 *) RSTRING_PTR (values);
+          length = RSTRING_LEN (values);
+        }
+
+      if (length % vertex_size)
+        rb_raise (rb_eArgError, "data length is not a multiple of "
+                  "the vertex size");
+
+      count = length / vertex_size;
+
+      if (first > layout->n_vertices || count > layout->n_vertices - first)
+        rb_raise (rb_eArgError, "The vertex range is out of bounds");
+
+      for (v = 0; v < count; v++)
+        memcpy (data + (first + v) * layout->stride + attribute->offset,
+                src + v * vertex_size, vertex_size);
+    }
+
+  return self;
+}
+
+static VALUE
+rb_cogl_vertex_layout_to_s (VALUE self)
+{
+  RBCoglVertexLayout *layout = rb_cogl_vertex_layout_get_pointer (self);
+
+  return rb_str_new ((const char *) rb_cogl_vertex_layout_get_data (layout),
+                     layout->n_vertices * layout->stride);
+}
+
+void
+rb_cogl_vertex_layout_init ()
+{
+  VALUE klass;
+
+  klass = rb_define_class_under (rbclt_c_cogl, "VertexLayout", rb_cObject);
+  rb_cogl_c_vertex_layout = klass;
+
+  rb_define_alloc_func (klass, rb_cogl_vertex_layout_alloc_with_class);
+
+  rb_define_method (klass, "initialize", rb_cogl_vertex_layout_initialize, 1);
+  rb_define_method (klass, "add", rb_cogl_vertex_layout_add, -1);
+  rb_define_method (klass, "n_vertices",
+                    rb_cogl_vertex_layout_get_n_vertices, 0);
+  rb_define_method (klass, "stride", rb_cogl_vertex_layout_get_stride, 0);
+  rb_define_method (klass, "offset", rb_cogl_vertex_layout_get_offset, 1);
+  rb_define_method (klass, "set", rb_cogl_vertex_layout_set, -1);
+  rb_define_method (klass, "to_s", rb_cogl_vertex_layout_to_s, 0);
+}
@@ -0,0 +1,58 @@
+/* Ruby bindings for the Clutter 'interactive canvas' library.
+ * Copyright (C) 2010  Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301  USA
+ */
+
+#ifndef _RB_COGL_VERTEX_LAYOUT_H
+#define _RB_COGL_VERTEX_LAYOUT_H
+
+#include <ruby.h>
+#include <cogl/cogl.h>
+
+typedef struct _RBCoglVertexLayout RBCoglVertexLayout;
+typedef struct _RBCoglVertexLayoutAttribute RBCoglVertexLayoutAttribute;
+
+struct _RBCoglVertexLayoutAttribute
+{
+  gchar *name;
+  guint8 n_components;
+  CoglAttributeType type;
+  gboolean normalized;
+  /* Byte offset of the attribute within each vertex */
+  guint offset;
+};
+
+struct _RBCoglVertexLayout
+{
+  guint n_vertices;
+  /* Size in bytes of one interleaved vertex */
+  guint stride;
+  GArray *attributes;
+  /* Interleaved vertex data. This is allocated the first time it is
+     needed after which no more attributes can be added */
+  guint8 *data;
+};
+
+RBCoglVertexLayout *rb_cogl_vertex_layout_get_pointer (VALUE self);
+
+gboolean rb_cogl_is_kind_of_vertex_layout (VALUE self);
+void rb_cogl_assert_is_kind_of_vertex_layout (VALUE arg);
+
+/* Returns the interleaved data, allocating it if necessary */
+guint8 *rb_cogl_vertex_layout_get_data (RBCoglVertexLayout *layout);
+
+#endif /* _RB_COGL_VERTEX_LAYOUT_H */
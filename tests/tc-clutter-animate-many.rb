@@ -0,0 +1,95 @@
+$:.unshift File.join(File.dirname(__FILE__), '..' , 'clutter')
+$:.unshift File.join(File.dirname(__FILE__))
+require 'clutter-init'
+require 'test/unit'
+
+class TC_ClutterAnimateMany < Test::Unit::TestCase
+  def setup
+    @actors = (0...2).map { Clutter::Rectangle.new }
+    @linear = Clutter::Curve.linear([ 0.0, 1.0 ])
+  end
+
+  def teardown
+    @actors = nil
+  end
+
+  # Moves the timeline to the given time and applies it to the actors
+  # without waiting for the master clock
+  def seek(timeline, msecs)
+    timeline.pause
+    timeline.advance(msecs)
+    timeline.signal_emit("new-frame", msecs)
+  end
+
+  def test_mid_point
+    timeline = Clutter::Animation.animate_many(@actors, @linear, 1000,
+                                               "x" => 100.0)
+    assert(timeline.playing?)
+    assert_equal(timeline.duration, 1000)
+
+    seek(timeline, 500)
+    @actors.each { |actor| assert_in_delta(actor.x, 50.0, 0.01) }
+    seek(timeline, 1000)
+    @actors.each { |actor| assert_in_delta(actor.x, 100.0, 0.01) }
+  end
+
+  def test_stagger
+    timeline = Clutter::Animation.animate_many(@actors, @linear, 1000,
+                                               { "x" => 100.0 },
+                                               :stagger => 400)
+    # The timeline is extended by the longest delay
+    assert_equal(timeline.duration, 1400)
+
+    seek(timeline, 400)
+    assert_in_delta(@actors[0].x, 40.0, 0.01)
+    assert_in_delta(@actors[1].x, 0.0, 0.01)
+    seek(timeline, 900)
+    assert_in_delta(@actors[0].x, 90.0, 0.01)
+    assert_in_delta(@actors[1].x, 50.0, 0.01)
+
+    # Separate delays can be given for each actor
+    others = (0...2).map { Clutter::Rectangle.new }
+    timeline = Clutter::Animation.animate_many(others, @linear, 1000,
+                                               { "y" => 100.0 }, [ 200, 0 ])
+    assert_equal(timeline.duration, 1200)
+    seek(timeline, 200)
+    assert_in_delta(others[0].y, 0.0, 0.01)
+    assert_in_delta(others[1].y, 20.0, 0.01)
+  end
+
+  def test_type_mismatch
+    # A group has no color property
+    assert_raises(ArgumentError) do
+      Clutter::Animation.animate_many([ Clutter::Rectangle.new,
+                                        Clutter::Group.new ],
+                                      @linear, 1000,
+                                      "color" => Clutter::Color.new(1, 2, 3))
+    end
+    assert_raises(ArgumentError) do
+      Clutter::Animation.animate_many(@actors, @linear, 1000,
+                                      "not-a-property" => 1)
+    end
+    assert_raises(ArgumentError) do
+      Clutter::Animation.animate_many([], @linear, 1000, "x" => 1.0)
+    end
+  end
+
+  def test_stop
+    timeline = Clutter::Animation.animate_many(@actors, @linear, 1000,
+                                               "x" => 100.0)
+    timeline.stop
+    assert(!timeline.playing?)
+
+    # Restarting a stopped timeline still animates
+    timeline.start
+    seek(timeline, 250)
+    @actors.each { |actor| assert_in_delta(actor.x, 25.0, 0.01) }
+
+    # Once stopped only the wrapper owns the timeline so dropping it
+    # frees the animation
+    timeline.stop
+    timeline = nil
+    GC.start
+    @actors.each { |actor| assert_in_delta(actor.x, 25.0, 0.01) }
+  end
+end
@@ -0,0 +1,123 @@
+$:.unshift File.join(File.dirname(__FILE__), '..' , 'clutter')
+$:.unshift File.join(File.dirname(__FILE__))
+require 'clutter-init'
+require 'test/unit'
+
+class TC_ClutterColumnarModel < Test::Unit::TestCase
+  def setup
+    @model = Clutter::ColumnarModel.new(Integer, "id",
+                                        Float, "size",
+                                        String, "name")
+  end
+
+  def teardown
+    @model = nil
+  end
+
+  def test_append_rows
+    @model.append_rows("id" => [ 1, 2, 3 ],
+                       :size => [ 1.5, 2.5, 3.5 ].pack("d*"),
+                       2 => [ "a", "b", nil ])
+
+    assert_equal(@model.n_rows, 3)
+    iter = @model.get_iter_at_row(1)
+    assert_equal(iter.get(0, 1, 2), [ 2, 2.5, "b" ])
+    assert_equal(@model.get_iter_at_row(2)[2], nil)
+
+    # Columns that aren't given are filled with zeroes
+    @model.append_rows("name" => [ "d" ])
+    assert_equal(@model.get_iter_at_row(3).get(0, 2), [ 0, "d" ])
+  end
+
+  def test_append_rows_errors
+    assert_raises(ArgumentError) do
+      @model.append_rows("id" => [ 1, 2 ], "size" => [ 1.0 ])
+    end
+    assert_raises(ArgumentError) { @model.append_rows("missing" => [ 1 ]) }
+    assert_raises(TypeError) { @model.append_rows("id" => [ 1, "x" ]) }
+    assert_equal(@model.n_rows, 0)
+  end
+
+  def test_append
+    @model.append(0, 7, 2, "seven")
+    @model.prepend(0, 6)
+    assert_equal(@model.n_rows, 2)
+    assert_equal(@model.first_iter.get(0, 2), [ 6, nil ])
+    assert_equal(@model.get_iter_at_row(1).get(0, 2), [ 7, "seven" ])
+
+    @model.remove(0)
+    assert_equal(@model.n_rows, 1)
+    assert_equal(@model.first_iter[0], 7)
+  end
+
+  def test_each
+    @model.append_rows("id" => (0...10).to_a)
+    ids = []
+    @model.each { |iter| ids << iter[0] }
+    assert_equal(ids, (0...10).to_a)
+  end
+
+  def test_rows
+    @model.append_rows("id" => [ 1, 2, 3 ],
+                       "size" => [ 1.5, 2.5, 3.5 ],
+                       "name" => [ "a", "b", "c" ])
+
+    assert_equal(@model.rows(1, 5, [ 2, 0 ]), [ "b", 2, "c", 3 ])
+    assert_equal(@model.rows(0, 1), [ 1, 1.5, "a" ])
+    assert_equal(@model.rows(2, 1, 1), [ 3.5 ])
+    assert_equal(@model.rows(3, 1), [])
+
+    # Columns can also be given by name
+    assert_equal(@model.rows(1, 5, [ "name", :id ]), [ "b", 2, "c", 3 ])
+    assert_equal(@model.rows(2, 1, :size), [ 3.5 ])
+    assert_raises(ArgumentError) { @model.rows(0, 1, "missing") }
+    assert_raises(ArgumentError) { @model.rows(0, 1, 3) }
+
+    assert_equal(@model.column_data("id", 1).unpack("i*"), [ 2, 3 ])
+    assert_equal(@model.column_data(1, 0, 2).unpack("d*"), [ 1.5, 2.5 ])
+    assert_raises(ArgumentError) { @model.column_data("name") }
+  end
+
+  def test_sort_keys
+    @model.append_rows("id" => [ 3, 1, 2, 1 ],
+                       "name" => [ "c", "b", "a", "a" ])
+    @model.set_sort_keys("id", [ "name", :descending ])
+    assert_equal(@model.column_data("id").unpack("i*"), [ 1, 1, 2, 3 ])
+    assert_equal(@model.rows(0, 2, 2), [ "b", "a" ])
+
+    # New rows are merged in to place
+    @model.append_rows("id" => [ 0, 5, 2 ])
+    assert_equal(@model.column_data("id").unpack("i*"),
+                 [ 0, 1, 1, 2, 2, 3, 5 ])
+
+    # Changing a key moves the row and tells views about it
+    sort_changed = 0
+    @model.signal_connect("sort-changed") { sort_changed += 1 }
+    iter = @model.first_iter
+    iter[0] = 4
+    assert_equal(iter.row, 5)
+    assert_equal(@model.column_data("id").unpack("i*"),
+                 [ 1, 1, 2, 2, 3, 4, 5 ])
+    assert_equal(sort_changed, 1)
+
+    # Changing a key without moving the row doesn't
+    iter[0] = 4
+    assert_equal(sort_changed, 1)
+
+    assert_raises(ArgumentError) { @model.set_sort_keys([ "id", :up ]) }
+  end
+
+  def test_native_sort_and_filter
+    @model.append_rows("id" => [ 3, 1, 2, 4 ],
+                       "name" => [ "ant", "bee", "ape", "cat" ])
+    @model.set_sort(0, :descending)
+    ids = []
+    @model.each { |iter| ids << iter[0] }
+    assert_equal(ids, [ 4, 3, 2, 1 ])
+
+    @model.set_native_filter([ 0, :range, 2, nil ], [ 2, :prefix, "a" ])
+    ids = []
+    @model.each { |iter| ids << iter[0] }
+    assert_equal(ids, [ 3, 2 ])
+  end
+end
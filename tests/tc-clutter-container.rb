@@ -0,0 +1,134 @@
+$:.unshift File.join(File.dirname(__FILE__), '..' , 'clutter')
+$:.unshift File.join(File.dirname(__FILE__))
+require 'clutter-init'
+require 'test/unit'
+require 'weakref'
+
+class TC_ClutterContainer < Test::Unit::TestCase
+  def setup
+    @group = Clutter::Group.new
+  end
+
+  def teardown
+    @group = nil
+  end
+
+  def test_bulk_add
+    actors = (0...100).map { Clutter::Rectangle.new }
+    @group.add(actors, Clutter::Rectangle.new)
+    assert_equal(@group.n_children, 101)
+    assert_equal(@group.children[0, 100], actors)
+
+    @group.remove(actors[0, 50])
+    assert_equal(@group.n_children, 51)
+
+    # Nothing is added if any of the actors is invalid
+    assert_raises(ArgumentError) do
+      @group.add(Clutter::Rectangle.new, [ Clutter::Rectangle.new, 1 ])
+    end
+    assert_equal(@group.n_children, 51)
+  end
+
+  def test_children_snapshot
+    a, b = Clutter::Rectangle.new, Clutter::Rectangle.new
+    @group.add(a, b)
+    children = @group.children
+    assert(children.frozen?)
+    assert_same(@group.children, children)
+
+    # Adding or reordering children gives a new snapshot
+    @group.raise_child(a, b)
+    assert_equal(@group.children, [ b, a ])
+    @group.add(Clutter::Rectangle.new)
+    assert_not_same(@group.children, children)
+    assert_equal(@group.children.length, 3)
+
+    # Reordering through the actor is also noticed
+    c = @group.children.last
+    c.lower_bottom
+    assert_equal(@group.children, [ c, b, a ])
+    c.raise_top
+    assert_equal(@group.children, [ b, a, c ])
+    b.depth = 10
+    assert_equal(@group.children, [ a, c, b ])
+
+    # Removing children while iterating doesn't affect the iteration
+    count = 0
+    @group.each { |child| @group.remove(child); count += 1 }
+    assert_equal(count, 3)
+    assert_equal(@group.children, [])
+  end
+
+  # Adds some actors to the container that are only referenced through
+  # it. They are created in a separate method so that no references to
+  # them are left on the stack of the test
+  def add_tagged_children(container, n)
+    n.times do |i|
+      actor = Clutter::Rectangle.new
+      actor.instance_variable_set(:@tag, i)
+      container << actor
+    end
+    nil
+  end
+
+  def weak_children(container)
+    refs = []
+    container.each { |child| refs << WeakRef.new(child) }
+    refs
+  end
+
+  def count_alive(refs)
+    refs.inject(0) { |count, ref| ref.weakref_alive? ? count + 1 : count }
+  end
+
+  def test_gc_keeps_children
+    inner = Clutter::Group.new
+    @group << inner
+    add_tagged_children(inner, 10)
+    inner = nil
+    GC.start
+
+    # The wrappers of the children are kept along with their state even
+    # though only the parent is referenced
+    inner = @group.children.first
+    tags = inner.children.map { |child| child.instance_variable_get(:@tag) }
+    assert_equal(tags, (0...10).to_a)
+  end
+
+  def test_gc_releases_removed_children
+    add_tagged_children(@group, 20)
+    refs = weak_children(@group)
+
+    # A removed or destroyed child is no longer marked through the
+    # parent so it can be collected. The snapshot is replaced so that
+    # it doesn't hold on to the old children either
+    @group.children.each_with_index do |child, i|
+      if i.even?
+        @group.remove(child)
+      else
+        child.destroy
+      end
+    end
+    assert_equal(@group.children, [])
+    GC.start
+
+    # The collector is conservative so a few wrappers may survive but
+    # a leak would keep all of them
+    assert(count_alive(refs) < refs.length / 2)
+  end
+
+  def test_gc_stale_snapshot
+    add_tagged_children(@group, 20)
+    snapshot = @group.children
+    refs = snapshot.map { |child| WeakRef.new(child) }
+    @group.remove(snapshot)
+
+    # The stale snapshot still holds the wrappers but once it is
+    # dropped the children are no longer kept by the container
+    assert_equal(snapshot.length, 20)
+    snapshot = nil
+    assert_equal(@group.children, [])
+    GC.start
+    assert(count_alive(refs) < refs.length / 2)
+  end
+end
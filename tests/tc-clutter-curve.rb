@@ -0,0 +1,77 @@
+$:.unshift File.join(File.dirname(__FILE__), '..' , 'clutter')
+$:.unshift File.join(File.dirname(__FILE__))
+require 'clutter-init'
+require 'test/unit'
+
+class TC_ClutterCurve < Test::Unit::TestCase
+  def test_cubic_bezier
+    curve = Clutter::Curve.cubic_bezier(0.25, 0.1, 0.25, 1.0)
+    assert_in_delta(curve.value_at(0.0), 0.0, 0.0001)
+    assert_in_delta(curve.value_at(1.0), 1.0, 0.0001)
+    assert(curve.value_at(0.5) > 0.5)
+
+    # A bezier with the control points on the diagonal is linear
+    curve = Clutter::Curve.cubic_bezier(1 / 3.0, 1 / 3.0, 2 / 3.0, 2 / 3.0)
+    [ 0.1, 0.3, 0.7, 0.9 ].each do |progress|
+      assert_in_delta(curve.value_at(progress), progress, 0.0001)
+    end
+
+    assert_raises(ArgumentError) do
+      Clutter::Curve.cubic_bezier(1.5, 0.0, 0.5, 1.0)
+    end
+  end
+
+  def test_linear
+    curve = Clutter::Curve.linear([ 0.0, 1.0, 0.5 ])
+    assert_in_delta(curve.value_at(0.25), 0.5, 0.0001)
+    assert_in_delta(curve.value_at(0.5), 1.0, 0.0001)
+    assert_in_delta(curve.value_at(0.75), 0.75, 0.0001)
+    assert_in_delta(curve.value_at(2.0), 0.5, 0.0001)
+
+    assert_raises(ArgumentError) { Clutter::Curve.linear([ 1.0 ]) }
+  end
+
+  def test_spring
+    curve = Clutter::Curve.spring
+    assert_in_delta(curve.value_at(0.0), 0.0, 0.0001)
+    assert_in_delta(curve.value_at(1.0), 1.0, 0.0001)
+  end
+
+  def test_steps
+    curve = Clutter::Curve.steps(4)
+    assert_equal(curve.value_at(0.2), 0.0)
+    assert_equal(curve.value_at(0.3), 0.25)
+    assert_equal(curve.value_at(1.0), 1.0)
+
+    curve = Clutter::Curve.steps(4, true)
+    assert_equal(curve.value_at(0.2), 0.25)
+  end
+
+  def test_alpha
+    id = Clutter::Alpha.register_func(Clutter::Curve.steps(2))
+    assert_kind_of(Integer, id)
+
+    timeline = Clutter::Timeline.new(1000)
+    alpha = Clutter::Alpha.new(timeline, Clutter::Curve.steps(2))
+    timeline.advance(600)
+    assert_equal(alpha.alpha, 0.5)
+  end
+
+  def test_sample
+    calls = 0
+    curve = Clutter::Alpha.sample(5) do |alpha|
+      calls += 1
+      alpha.timeline.progress ** 2
+    end
+    assert_equal(calls, 5)
+    assert_in_delta(curve.value_at(0.5), 0.25, 0.0001)
+    assert_in_delta(curve.value_at(0.625), 0.40625, 0.0001)
+
+    timeline = Clutter::Timeline.new(1000)
+    alpha = Clutter::Alpha.new(timeline, lambda { |a| 0.5 }, 16)
+    timeline.advance(300)
+    assert_in_delta(alpha.alpha, 0.5, 0.0001)
+
+    assert_raises(ArgumentError) { Clutter::Alpha.sample(1) { |a| 0.0 } }
+  end
+end
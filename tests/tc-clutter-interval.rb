@@ -0,0 +1,60 @@
+$:.unshift File.join(File.dirname(__FILE__), '..' , 'clutter')
+$:.unshift File.join(File.dirname(__FILE__))
+require 'clutter-init'
+require 'test/unit'
+
+class TC_ClutterInterval < Test::Unit::TestCase
+  PROGRESS = [ 0.0, 0.1, 0.25, 0.5, 0.9, 1.0 ]
+
+  def test_compute_value
+    interval = Clutter::Interval.new(GLib::Type["gint"], 0, 100)
+    assert_equal(PROGRESS.map { |p| interval.compute_value(p) },
+                 [ 0, 10, 25, 50, 90, 100 ])
+
+    interval = Clutter::Interval.new(GLib::Type["gdouble"], 1.0, 3.0)
+    assert_in_delta(interval.compute_value(0.5), 2.0, 0.0001)
+  end
+
+  def test_compute_many_numeric
+    interval = Clutter::Interval.new(GLib::Type["gdouble"], 10.0, 20.0)
+    result = interval.compute_many(PROGRESS)
+    assert_kind_of(Cogl::AttributeArray, result)
+    assert_equal(result.length, PROGRESS.length)
+    PROGRESS.each_with_index do |p, i|
+      assert_in_delta(result[i], interval.compute_value(p), 0.0001)
+    end
+
+    # The same output array can be used again
+    assert_same(interval.compute_many(PROGRESS, result), result)
+  end
+
+  def test_compute_many_color
+    interval = Clutter::Interval.new(Clutter::Color,
+                                     Clutter::Color.new(0, 0, 0, 0),
+                                     Clutter::Color.new(200, 100, 40, 255))
+    result = interval.compute_many([ 0.0, 0.5, 1.0 ])
+    assert_equal(result.length, 12)
+    assert_equal((0...4).map { |i| result[i] }, [ 0, 0, 0, 0 ])
+    color = interval.compute_value(0.5)
+    assert_equal((4...8).map { |i| result[i] },
+                 [ color.red, color.green, color.blue, color.alpha ])
+    assert_equal((8...12).map { |i| result[i] }, [ 200, 100, 40, 255 ])
+  end
+
+  def test_compute_many_generic
+    # Clutter doesn't interpolate strings so there is no fast path
+    interval = Clutter::Interval.new(GLib::Type["gchararray"], "a", "b")
+    result = interval.compute_many([ 0.0, 1.0 ])
+    assert_kind_of(Array, result)
+    assert_equal(result.length, 2)
+  end
+
+  def test_compute_many_bad_output
+    interval = Clutter::Interval.new(GLib::Type["gdouble"], 0.0, 1.0)
+    assert_raises(TypeError) { interval.compute_many(PROGRESS, "not an array") }
+    assert_raises(TypeError) { interval.compute_many(PROGRESS, 42) }
+    assert_raises(ArgumentError) do
+      interval.compute_many(PROGRESS, interval.compute_many([ 0.5 ]))
+    end
+  end
+end
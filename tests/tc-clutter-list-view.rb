@@ -0,0 +1,140 @@
+$:.unshift File.join(File.dirname(__FILE__), '..' , 'clutter')
+$:.unshift File.join(File.dirname(__FILE__))
+require 'clutter-init'
+require 'test/unit'
+require 'stringio'
+
+class TC_ClutterListView < Test::Unit::TestCase
+  def setup
+    @model = Clutter::ColumnarModel.new(String, "name")
+    @model.append_rows("name" => (0...1000).map { |i| "row #{i}" })
+    @created = 0
+    @bound = 0
+    @view = Clutter::ListView.new(@model, 10) do
+      @created += 1
+      Clutter::Text.new
+    end
+    @view.on_bind_row do |actor, iter|
+      @bound += 1
+      actor.text = iter[0]
+    end
+    @view.set_size(100, 50)
+  end
+
+  def teardown
+    @view.destroy if @view
+    @view = nil
+    @model = nil
+  end
+
+  def test_recycles_actors
+    @view.refresh
+    # One more actor than fits so that a partial row can be shown
+    assert_equal(@view.n_row_actors, 6)
+    assert_equal(@created, 6)
+    assert_equal(@view.row_actor(3).text, "row 3")
+    assert_nil(@view.row_actor(6))
+
+    # Scrolling by one row only rebinds the actor that came into view
+    @bound = 0
+    @view.scroll_to_row(1)
+    @view.refresh
+    assert_equal(@bound, 1)
+    assert_equal(@view.row_actor(6).text, "row 6")
+    assert_equal(@view.row_actor(6).y, 50)
+
+    @view.scroll_offset = 5000
+    @view.refresh
+    assert_equal(@created, 6)
+  end
+
+  def test_model_changes
+    @view.refresh
+    @bound = 0
+    @model.get_iter_at_row(2)[0] = "changed"
+    @view.refresh
+    assert_equal(@bound, 1)
+    assert_equal(@view.row_actor(2).text, "changed")
+
+    # Rows that aren't visible don't cause any rebinding
+    @bound = 0
+    @model.get_iter_at_row(500)[0] = "hidden"
+    @view.refresh
+    assert_equal(@bound, 0)
+  end
+
+  def test_removed_actors
+    @view.refresh
+    actor = @view.row_actor(0)
+
+    # Removing or destroying a row actor frees its slot and a new
+    # actor is created to replace it
+    @view.remove(actor)
+    assert_equal(@view.n_row_actors, 5)
+    @view.row_actor(1).destroy
+    assert_equal(@view.n_row_actors, 4)
+    @view.refresh
+    assert_equal(@view.n_row_actors, 6)
+    assert_equal(@created, 8)
+    assert_equal(@view.row_actor(0).text, "row 0")
+
+    @view.remove_all
+    assert_equal(@view.n_row_actors, 0)
+    @view.refresh
+    assert_equal(@view.n_row_actors, 6)
+  end
+
+  def run_frame
+    GLib::Timeout.add(200) { Clutter.main_quit; false }
+    Clutter.main
+  end
+
+  def test_destroy
+    stage = Clutter::Stage.default
+    stage << @view
+    stage.show
+
+    # Changing the model queues a refresh which must not run once the
+    # view has gone
+    @model.get_iter_at_row(0)[0] = "changed"
+    @view.destroy
+    @view = nil
+    GC.start
+    run_frame
+  end
+
+  def test_deferred_errors
+    stage = Clutter::Stage.default
+    stage << @view
+    stage.show
+    @view.on_create_row { "not an actor" }
+
+    # Errors in the blocks during a frame are reported without
+    # leaving the main loop
+    old_stderr, $stderr = $stderr, StringIO.new
+    begin
+      @model.get_iter_at_row(0)[0] = "changed"
+      run_frame
+      warning = $stderr.string
+    ensure
+      $stderr = old_stderr
+    end
+    assert_match(/TypeError/, warning)
+    assert_equal(@view.n_row_actors, 0)
+
+    # An explicit refresh raises them instead
+    assert_raises(TypeError) { @view.refresh }
+
+    # A row whose bind block raised is bound again on the next refresh
+    fail_bind = true
+    @view.on_create_row { Clutter::Text.new }
+    @view.on_bind_row do |actor, iter|
+      raise "bind failed" if fail_bind
+      actor.text = iter[0]
+    end
+    assert_raises(RuntimeError) { @view.refresh }
+    fail_bind = false
+    @view.refresh
+    assert_equal(@view.row_actor(0).text, "changed")
+  end
+end
@@ -0,0 +1,121 @@
+$:.unshift File.join(File.dirname(__FILE__), '..' , 'clutter')
+$:.unshift File.join(File.dirname(__FILE__))
+require 'clutter-init'
+require 'test/unit'
+
+class TC_ClutterOffscreenRenderer < Test::Unit::TestCase
+  SIZE = 10
+
+  def setup
+    @stage = Clutter::Stage.get_default
+    @stage.show
+    @renderer = Clutter::OffscreenRenderer.new(SIZE, SIZE, @stage)
+  end
+
+  def teardown
+    @renderer = nil
+    @stage.hide
+  end
+
+  def make_rect(size, color)
+    rect = Clutter::Rectangle.new(color)
+    rect.set_size(size, size)
+    rect
+  end
+
+  # Returns the RGBA bytes of a pixel as an array
+  def pixel(pixels, x, y)
+    pixels[(y * SIZE + x) * 4, 4].unpack("C*")
+  end
+
+  def assert_pixel(pixels, x, y, expected)
+    pixel(pixels, x, y).zip(expected).each do |actual, component|
+      assert_in_delta(actual, component, 2)
+    end
+  end
+
+  def test_solid_rectangle
+    rect = make_rect(SIZE, Clutter::Color.new(255, 0, 0, 255))
+    pixels = @renderer.render(rect)
+    assert_equal(pixels.length, SIZE * SIZE * 4)
+    assert_pixel(pixels, 0, 0, [ 255, 0, 0, 255 ])
+    assert_pixel(pixels, SIZE - 1, SIZE - 1, [ 255, 0, 0, 255 ])
+
+    # The texture is premultiplied but the pixels are returned without
+    # the alpha applied
+    rect.color = Clutter::Color.new(255, 0, 0, 128)
+    assert_pixel(@renderer.render(rect), 5, 5, [ 255, 0, 0, 128 ])
+  end
+
+  def test_fit
+    rect = make_rect(SIZE / 2, Clutter::Color.new(0, 0, 255, 255))
+
+    # Without fitting only the top left corner is covered
+    pixels = @renderer.render(rect)
+    assert_pixel(pixels, 0, 0, [ 0, 0, 255, 255 ])
+    assert_pixel(pixels, SIZE - 1, SIZE - 1, [ 0, 0, 0, 0 ])
+
+    pixels = @renderer.render(rect, true)
+    assert_pixel(pixels, SIZE - 1, SIZE - 1, [ 0, 0, 255, 255 ])
+  end
+
+  def test_unparented_actor
+    rect = make_rect(SIZE, Clutter::Color.new(0, 255, 0, 255))
+    n_children = @stage.n_children
+
+    # The actor is only added to the stage while it is painted
+    parent_during_paint = nil
+    rect.signal_connect("paint") { parent_during_paint = rect.parent }
+    @renderer.render(rect)
+    assert_same(parent_during_paint, @stage)
+    assert_nil(rect.parent)
+    assert_equal(@stage.n_children, n_children)
+
+    # An actor that is parented but not mapped can't be painted
+    group = Clutter::Group.new
+    group << rect
+    assert_raises(ArgumentError) { @renderer.render(rect) }
+    assert_same(rect.parent, group)
+  end
+
+  def test_raising_paint_handler
+    rect = make_rect(SIZE, Clutter::Color.new(255, 255, 0, 255))
+    n_children = @stage.n_children
+    viewport = Cogl.get_viewport
+
+    handler = rect.signal_connect("paint") { raise "paint failed" }
+    assert_raises(RuntimeError) { @renderer.render(rect) }
+
+    # The actor is taken off the stage again and the framebuffer is
+    # popped so the viewport is back to the stage's
+    assert_nil(rect.parent)
+    assert_equal(@stage.n_children, n_children)
+    assert_equal(Cogl.get_viewport, viewport)
+
+    rect.signal_handler_disconnect(handler)
+    assert_pixel(@renderer.render(rect), 5, 5, [ 255, 255, 0, 255 ])
+  end
+
+  def test_render_all
+    colors = [ [ 255, 0, 0, 255 ], [ 0, 255, 0, 255 ], [ 0, 0, 255, 255 ] ]
+    rects = colors.map { |c| make_rect(SIZE, Clutter::Color.new(*c)) }
+
+    # With a block the same string is reused for every actor
+    buffers = []
+    yielded = []
+    @renderer.render_all(rects) do |actor, pixels|
+      yielded << actor
+      buffers << pixels
+      assert_pixel(pixels, 5, 5, colors[rects.index(actor)])
+    end
+    assert_equal(yielded, rects)
+    assert(buffers.all? { |buf| buf.equal?(buffers.first) })
+
+    # Without a block each actor gets its own string
+    results = @renderer.render_all(rects)
+    assert_equal(results.length, 3)
+    results.each_with_index do |pixels, i|
+      assert_pixel(pixels, 5, 5, colors[i])
+    end
+  end
+end
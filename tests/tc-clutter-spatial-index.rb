@@ -0,0 +1,99 @@
+$:.unshift File.join(File.dirname(__FILE__), '..' , 'clutter')
+$:.unshift File.join(File.dirname(__FILE__))
+require 'clutter-init'
+require 'test/unit'
+
+class TC_ClutterSpatialIndex < Test::Unit::TestCase
+  # CLUTTER_PICK_REACTIVE
+  PICK_REACTIVE = 1
+
+  def setup
+    @stage = Clutter::Stage.get_default
+    @stage.set_size(200, 200)
+    @stage.show
+
+    @a = make_rect(10, 10, 50, 50, true)
+    @b = make_rect(40, 40, 50, 50, true)
+    @c = make_rect(100, 100, 50, 50, false)
+    @stage.add(@a, @b, @c)
+    @stage.enable_spatial_index(32)
+  end
+
+  def teardown
+    @stage.disable_spatial_index
+    @stage.remove(@a, @b, @c)
+    @stage.hide
+  end
+
+  def make_rect(x, y, width, height, reactive)
+    rect = Clutter::Rectangle.new
+    rect.set_position(x, y)
+    rect.set_size(width, height)
+    rect.reactive = reactive
+    rect
+  end
+
+  def test_enable
+    assert(@stage.spatial_index_enabled?)
+    @stage.disable_spatial_index
+    assert(!@stage.spatial_index_enabled?)
+    assert_raises(ArgumentError) { @stage.enable_spatial_index(0) }
+  end
+
+  def test_get_actor_at_pos
+    # The topmost reactive actor is found
+    assert_equal(@stage.get_actor_at_pos(PICK_REACTIVE, 15, 15), @a)
+    assert_equal(@stage.get_actor_at_pos(PICK_REACTIVE, 45, 45), @b)
+    # Actors that aren't reactive are skipped
+    assert_equal(@stage.get_actor_at_pos(PICK_REACTIVE, 120, 120), @stage)
+  end
+
+  def test_actors_in_rect
+    assert_equal(@stage.actors_in_rect(0, 0, 200, 200), [ @a, @b ])
+    assert_equal(@stage.actors_in_rect(0, 0, 20, 20), [ @a ])
+    assert_equal(@stage.actors_in_rect(160, 0, 20, 20), [])
+  end
+
+  def test_changes_rebuild_the_index
+    assert_equal(@stage.actors_in_rect(0, 0, 20, 20), [ @a ])
+
+    @a.set_position(150, 0)
+    assert_equal(@stage.actors_in_rect(0, 0, 20, 20), [])
+    assert_equal(@stage.actors_in_rect(160, 0, 20, 20), [ @a ])
+
+    @b.reactive = false
+    assert_equal(@stage.actors_in_rect(0, 0, 200, 200), [ @a ])
+
+    @stage.remove(@a)
+    assert_equal(@stage.get_actor_at_pos(PICK_REACTIVE, 160, 10), @stage)
+    @stage.add(@a)
+    assert_equal(@stage.get_actor_at_pos(PICK_REACTIVE, 160, 10), @a)
+  end
+
+  def test_restacking_rebuilds_the_index
+    assert_equal(@stage.get_actor_at_pos(PICK_REACTIVE, 45, 45), @b)
+
+    # Restacking actors at the same depth doesn't emit any signals
+    @stage.raise_child(@a, @b)
+    assert_equal(@stage.get_actor_at_pos(PICK_REACTIVE, 45, 45), @a)
+    assert_equal(@stage.actors_in_rect(0, 0, 200, 200), [ @b, @a ])
+
+    @a.lower_bottom
+    assert_equal(@stage.get_actor_at_pos(PICK_REACTIVE, 45, 45), @b)
+    @a.raise_top
+    assert_equal(@stage.get_actor_at_pos(PICK_REACTIVE, 45, 45), @a)
+
+    # Restacking a group moves all of its children
+    group = Clutter::Group.new
+    @stage.remove(@b)
+    group.add(@b)
+    @stage.add(group)
+    @stage.lower_child(group, @a)
+    assert_equal(@stage.get_actor_at_pos(PICK_REACTIVE, 45, 45), @a)
+    @stage.raise_child(group, @a)
+    assert_equal(@stage.get_actor_at_pos(PICK_REACTIVE, 45, 45), @b)
+    group.remove(@b)
+    @stage.remove(group)
+    @stage.add(@b)
+  end
+end
@@ -0,0 +1,77 @@
+$:.unshift File.join(File.dirname(__FILE__), '..' , 'clutter')
+$:.unshift File.join(File.dirname(__FILE__))
+require 'clutter-init'
+require 'test/unit'
+
+class TC_ClutterStageCapture < Test::Unit::TestCase
+  WIDTH = 20
+  HEIGHT = 10
+
+  def setup
+    @stage = Clutter::Stage.get_default
+    @stage.set_size(100, 100)
+    @stage.show
+    @frames = []
+    @capture = Clutter::StageCapture.new(@stage, 0, 0, WIDTH, HEIGHT,
+                                         2) { |buf| @frames << buf }
+  end
+
+  def teardown
+    @capture.stop
+    @capture = nil
+    @stage.hide
+  end
+
+  # Runs the main loop for a while, redrawing the stage on every
+  # iteration so that several frames are painted
+  def run_frames(msecs = 300)
+    redraw = GLib::Timeout.add(20) { @stage.queue_redraw; true }
+    GLib::Timeout.add(msecs) { Clutter.main_quit; false }
+    Clutter.main
+    GLib::Source.remove(redraw)
+  end
+
+  def test_capture
+    assert(!@capture.running?)
+    @capture.start
+    assert(@capture.running?)
+    run_frames(200)
+
+    assert(@frames.length >= 1)
+    @frames.each { |buf| assert_equal(buf.length, WIDTH * HEIGHT * 4) }
+    assert_same(@capture.stage, @stage)
+  end
+
+  def test_buffers_are_held_until_released
+    @capture.start
+    run_frames
+
+    # Both buffers are held by the block so the other frames are dropped
+    assert_equal(@frames.length, 2)
+    assert(@capture.n_dropped > 0)
+    assert_not_same(@frames[0], @frames[1])
+
+    # Releasing a buffer lets it be used for the next frame
+    @capture.release(@frames[0])
+    run_frames
+    assert_equal(@frames.length, 3)
+    assert_same(@frames[2], @frames[0])
+
+    # A buffer can only be released while the block holds it
+    assert_raises(ArgumentError) { @capture.release(@frames[0] * 1) }
+    @capture.release(@frames[1])
+    assert_raises(ArgumentError) { @capture.release(@frames[1]) }
+
+    # A frozen buffer can't be reused so it isn't released
+    @frames[2].freeze
+    assert_raises(TypeError, RuntimeError) { @capture.release(@frames[2]) }
+  end
+
+  def test_stop
+    @capture.start
+    @capture.stop
+    assert(!@capture.running?)
+    run_frames(200)
+    assert_equal(@frames, [])
+  end
+end
@@ -0,0 +1,106 @@
+$:.unshift File.join(File.dirname(__FILE__), '..' , 'clutter')
+$:.unshift File.join(File.dirname(__FILE__))
+require 'clutter-init'
+require 'test/unit'
+require 'json'
+
+class TC_ClutterStats < Test::Unit::TestCase
+  def setup
+    Clutter::Stats.enable
+    Clutter::Stats.reset
+  end
+
+  def teardown
+    Clutter::Stats.disable
+  end
+
+  # Runs the main loop long enough for the master clock to paint a
+  # frame
+  def run_frames
+    GLib::Timeout.add(200) { Clutter.main_quit; false }
+    Clutter.main
+  end
+
+  def test_enable
+    assert(Clutter::Stats.enabled?)
+    Clutter::Stats.disable
+    assert(!Clutter::Stats.enabled?)
+    Clutter::Stats.enable
+    assert(Clutter::Stats.enabled?)
+  end
+
+  def test_categories
+    categories = Clutter::Stats.categories
+    assert_equal(categories, [ :paint, :layout, :pick, :event,
+                               :timeline, :alpha, :frame_source ])
+    assert_equal(Clutter::Stats.to_h.keys.sort_by { |c| c.to_s },
+                 categories.sort_by { |c| c.to_s })
+  end
+
+  def test_reset
+    Clutter::Stats.reset
+    assert_equal(Clutter::Stats.n_frames, 0)
+
+    Clutter::Stats.categories.each do |category|
+      data = Clutter::Stats[category]
+      assert_equal(data[:calls], 0)
+      assert_equal(data[:frames], 0)
+      assert_equal(data[:total], 0.0)
+      assert_equal(data[:max], 0.0)
+      assert_equal(data[:mean], 0.0)
+      assert_equal(data[:histogram], [ 0 ] * Clutter::Stats::N_BUCKETS)
+    end
+  end
+
+  def test_lookup
+    assert_equal(Clutter::Stats["paint"], Clutter::Stats[:paint])
+    assert_raises(ArgumentError) { Clutter::Stats[:not_a_category] }
+  end
+
+  def test_records_frames
+    stage = Clutter::Stage.get_default
+    rect = Clutter::Rectangle.new
+    stage.add(rect)
+    stage.show
+
+    new_frames = 0
+    timeline = Clutter::Timeline.new(1000)
+    alpha = Clutter::Alpha.new(timeline) { |a| 0.5 }
+    timeline.signal_connect("new-frame") do
+      new_frames += 1
+      alpha.alpha
+    end
+    timeline.start
+
+    # Changing the size forces a relayout as well as a paint
+    Clutter::Stats.reset
+    rect.set_size(10, 10)
+    stage.queue_redraw
+    run_frames
+
+    timeline.stop
+    stage.remove(rect)
+    stage.hide
+
+    assert(Clutter::Stats.n_frames > 0)
+    assert(Clutter::Stats[:paint][:calls] > 0)
+    assert(Clutter::Stats[:layout][:calls] > 0)
+    assert(new_frames > 0)
+    assert(Clutter::Stats[:timeline][:calls] > 0)
+    assert(Clutter::Stats[:alpha][:calls] > 0)
+    assert_equal(Clutter::Stats[:paint][:frames], Clutter::Stats.n_frames)
+  end
+
+  def test_to_json
+    json = JSON.parse(Clutter::Stats.to_json)
+    assert_equal(json["frames"], Clutter::Stats.n_frames)
+
+    Clutter::Stats.to_h.each do |category, data|
+      json_data = json[category.to_s]
+      assert_not_nil(json_data)
+      data.each do |key, value|
+        assert_equal(json_data[key.to_s], value)
+      end
+    end
+  end
+end
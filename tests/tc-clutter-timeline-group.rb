@@ -0,0 +1,73 @@
+$:.unshift File.join(File.dirname(__FILE__), '..' , 'clutter')
+$:.unshift File.join(File.dirname(__FILE__))
+require 'clutter-init'
+require 'test/unit'
+
+class TC_ClutterTimelineGroup < Test::Unit::TestCase
+  def setup
+    @timelines = (0...3).map { Clutter::Timeline.new(100) }
+  end
+
+  def teardown
+    @timelines = nil
+  end
+
+  def test_initialize
+    group = Clutter::TimelineGroup.new(@timelines) { |ticks| }
+    assert_equal(group.size, 3)
+    assert_equal(group.length, 3)
+    assert_equal(group.timelines, @timelines)
+
+    assert_equal(Clutter::TimelineGroup.new.size, 0)
+  end
+
+  def test_add_remove
+    group = Clutter::TimelineGroup.new
+    assert_same(group.add(@timelines[0]), group)
+    group << @timelines[1]
+    assert_equal(group.timelines, @timelines[0, 2])
+
+    # Adding a timeline twice does nothing
+    group << @timelines[0]
+    assert_equal(group.size, 2)
+
+    assert_same(group.remove(@timelines[0]), group)
+    assert_equal(group.timelines, [ @timelines[1] ])
+
+    # Removing a timeline that isn't in the group does nothing
+    group.remove(@timelines[2])
+    assert_equal(group.size, 1)
+
+    group.remove(@timelines[1])
+    assert_equal(group.size, 0)
+  end
+
+  def test_on_frame
+    group = Clutter::TimelineGroup.new
+    assert_raises(LocalJumpError, ArgumentError) { group.on_frame }
+    assert_same(group.on_frame { |ticks| }, group)
+  end
+
+  def test_playback
+    group = Clutter::TimelineGroup.new(@timelines)
+
+    group.start
+    assert(@timelines.all? { |t| t.playing? })
+    group.pause
+    assert(@timelines.all? { |t| !t.playing? })
+    group.start
+    group.stop
+    assert(@timelines.all? { |t| !t.playing? })
+    assert_same(group.rewind, group)
+  end
+
+  def test_kept_alive_with_members
+    # A group with members must survive a garbage collection even
+    # without a Ruby reference so that it keeps dispatching
+    Clutter::TimelineGroup.new(@timelines) { |ticks| }
+    GC.start
+    count = 0
+    ObjectSpace.each_object(Clutter::TimelineGroup) { |g| count += 1 }
+    assert(count >= 1)
+  end
+end
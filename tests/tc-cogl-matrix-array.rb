@@ -0,0 +1,61 @@
+require 'test/unit'
+$:.unshift File.join(File.dirname(__FILE__), '..' , 'clutter')
+$:.unshift File.join(File.dirname(__FILE__))
+require 'clutter-init'
+
+class TC_CoglMatrixArray < Test::Unit::TestCase
+  def setup
+    @array = Cogl::MatrixArray.new(3)
+  end
+
+  def teardown
+    @array = nil
+  end
+
+  def test_identity
+    assert_equal(@array.length, 3)
+    assert_equal(@array[2].to_a, Cogl::Matrix.new.to_a)
+    assert_raises(ArgumentError) { @array[3] }
+    assert_raises(ArgumentError) { @array[-1] }
+  end
+
+  def test_set
+    matrix = Cogl::Matrix.new
+    matrix.scale!(2, 2, 2)
+    @array[1] = matrix
+    assert_equal(@array[1].to_a, matrix.to_a)
+
+    @array.set_element(0, 12, 5)
+    assert_equal(@array.get_element(0, 12), 5)
+    assert_raises(ArgumentError) { @array.get_element(0, 16) }
+    assert_raises(TypeError) { @array[0] = "matrix" }
+  end
+
+  def test_multiply
+    translation = Cogl::Matrix.new
+    translation.translate!(1, 2, 3)
+    @array.multiply!(translation)
+
+    expected = Cogl::Matrix.new * translation
+    @array.length.times { |i| assert_equal(@array[i].to_a, expected.to_a) }
+
+    @array.invert!
+    assert_equal(@array[0].transform_points([ 1, 2 ].pack("f*"), 2).
+                 unpack("f*"), [ 0, 0 ])
+  end
+
+  def test_transform_points
+    @array.set_element(1, 12, 10)
+    points = @array.transform_points([ 1, 1, 1, 1, 1, 1 ].pack("f*"), 2)
+    assert_equal(points.unpack("f*"), [ 1, 1, 11, 1, 1, 1 ])
+    assert_raises(ArgumentError) do
+      @array.transform_points([ 1, 1 ].pack("f*"), 2)
+    end
+  end
+
+  def test_copy
+    copy = @array.dup
+    copy.set_element(0, 0, 3)
+    assert_equal(@array.get_element(0, 0), 1)
+  end
+end
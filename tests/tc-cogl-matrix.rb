@@ -0,0 +1,59 @@
+require 'test/unit'
+$:.unshift File.join(File.dirname(__FILE__), '..' , 'clutter')
+$:.unshift File.join(File.dirname(__FILE__))
+require 'clutter-init'
+
+class TC_CoglMatrix < Test::Unit::TestCase
+  def setup
+    @matrix = Cogl::Matrix.new
+    @matrix.translate!(1, 2, 3)
+  end
+
+  def teardown
+    @matrix = nil
+  end
+
+  def test_transform_points_string
+    points = [ 0, 0, 10, 20 ].pack("f*")
+    result = @matrix.transform_points(points, 2)
+    assert_equal(result.unpack("f*"), [ 1, 2, 11, 22 ])
+    # The original string is left untouched
+    assert_equal(points.unpack("f*"), [ 0, 0, 10, 20 ])
+  end
+
+  def test_transform_points_in_place
+    points = Cogl::AttributeArray.new(Cogl::AttributeType::FLOAT,
+                                      [ 0, 0, 0, 1, 1, 1 ])
+    assert_same(@matrix.transform_points(points, 3), points)
+    assert_equal(points.to_a, [ 1, 2, 3, 2, 3, 4 ])
+  end
+
+  def test_transform_points_output
+    output = Cogl::AttributeArray.new(Cogl::AttributeType::FLOAT, 4)
+    assert_same(@matrix.transform_points([ 0, 0, 5, 5 ].pack("f*"), 2,
+                                         output), output)
+    assert_equal(output.to_a, [ 1, 2, 6, 7 ])
+  end
+
+  def test_transform_points_errors
+    output = Cogl::AttributeArray.new(Cogl::AttributeType::FLOAT,
+                                      [ 9, 9, 9, 9 ])
+
+    # Nothing is written to the output if the input is invalid
+    assert_raises(ArgumentError) do
+      @matrix.transform_points([ 0, 0, 0, 0 ].pack("f*") + "x", 2, output)
+    end
+    assert_raises(ArgumentError) do
+      @matrix.transform_points([ 0, 0, 0, 0 ].pack("f*"), 3, output)
+    end
+    assert_raises(ArgumentError) do
+      @matrix.transform_points([ 0, 0 ].pack("f*"), 2, output)
+    end
+    assert_equal(output.to_a, [ 9, 9, 9, 9 ])
+
+    assert_raises(ArgumentError) { @matrix.transform_points("", 5) }
+    assert_raises(TypeError) do
+      @matrix.transform_points([ 0, 0 ].pack("f*"), 2, "output")
+    end
+  end
+end
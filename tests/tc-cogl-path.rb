@@ -0,0 +1,53 @@
+require 'test/unit'
+$:.unshift File.join(File.dirname(__FILE__), '..' , 'clutter')
+$:.unshift File.join(File.dirname(__FILE__))
+require 'clutter-init'
+
+class TC_CoglPath < Test::Unit::TestCase
+  def setup
+    @path = Cogl::Path.new
+  end
+
+  def teardown
+    @path = nil
+  end
+
+  def test_build
+    assert_same(@path.move_to(0, 0), @path)
+    assert_same(@path.line_to(10, 0), @path)
+    assert_same(@path.rel_line_to(0, 10), @path)
+    assert_same(@path.curve_to(0, 0, 5, 5, 10, 10), @path)
+    assert_same(@path.arc(5, 5, 5, 5, 0, 90), @path)
+    assert_same(@path.rectangle(0, 0, 10, 10), @path)
+    assert_same(@path.round_rectangle(0, 0, 10, 10, 2, 10), @path)
+    assert_same(@path.polyline(0, 0, 5, 5, 10, 0), @path)
+    assert_same(@path.polygon([ 0, 0, 5, 5, 10, 0 ].pack("f*")), @path)
+    assert_same(@path.close, @path)
+    assert_kind_of(Cogl::Path, @path.dup)
+  end
+
+  def test_arguments
+    assert_raises(ArgumentError) { @path.move_to(1) }
+    assert_raises(ArgumentError) { @path.close(1) }
+    assert_raises(ArgumentError) { @path.rectangle(0, 0, 1, 1, 1) }
+  end
+
+  def test_does_not_dispatch_through_cogl
+    # The instance methods call the C implementation directly so
+    # redefining the module functions doesn't affect them
+    class << Cogl
+      alias_method :saved_path_line_to, :path_line_to
+      def path_line_to(x, y)
+        raise "Cogl.path_line_to called"
+      end
+    end
+    begin
+      assert_nothing_raised { @path.move_to(0, 0).line_to(1, 1) }
+    ensure
+      class << Cogl
+        alias_method :path_line_to, :saved_path_line_to
+        remove_method :saved_path_line_to
+      end
+    end
+  end
+end
@@ -0,0 +1,46 @@
+require 'test/unit'
+$:.unshift File.join(File.dirname(__FILE__), '..' , 'clutter')
+$:.unshift File.join(File.dirname(__FILE__))
+require 'clutter-init'
+
+class TC_CoglVector3 < Test::Unit::TestCase
+  def test_in_place
+    v = Cogl::Vector3.new(1, 2, 3)
+    assert_same(v.add!(Cogl::Vector3.new(1, 1, 1)), v)
+    assert_equal(v.to_a, [ 2, 3, 4 ])
+    v.subtract!(Cogl::Vector3.new(2, 3, 0))
+    assert_equal(v.to_a, [ 0, 0, 4 ])
+    v.multiply_scalar!(2)
+    assert_equal(v.to_a, [ 0, 0, 8 ])
+    v.normalize!
+    assert_equal(v.to_a, [ 0, 0, 1 ])
+    v.cross_product!(Cogl::Vector3.new(1, 0, 0))
+    assert_equal(v.to_a, [ 0, 1, 0 ])
+    v.invert!
+    assert_equal(v.to_a, [ 0, -1, 0 ])
+    v.set(4, 5, 6)
+    assert_equal(v.to_a, [ 4, 5, 6 ])
+  end
+
+  def test_array
+    array = Cogl::Vector3Array.new(2)
+    array.set(0, 3, 0, 0)
+    array[1] = Cogl::Vector3.new(0, 4, 0)
+    assert_equal(array.magnitudes.to_a, [ 3, 4 ])
+
+    array.add!(Cogl::Vector3.new(0, 0, 1))
+    assert_equal(array.to_a.map { |v| v.to_a }, [ [ 3, 0, 1 ], [ 0, 4, 1 ] ])
+
+    other = array.dup
+    array.subtract!(other)
+    assert_equal(array.magnitudes.to_a, [ 0, 0 ])
+
+    other.multiply_scalar!(2)
+    assert_equal(other.dot_products(Cogl::Vector3.new(1, 1, 1)).to_a,
+                 [ 8, 10 ])
+    assert_equal(other.to_s.length, 2 * 3 * 4)
+
+    assert_raises(ArgumentError) { array.add!(Cogl::Vector3Array.new(3)) }
+    assert_raises(ArgumentError) { array[2] }
+  end
+end
@@ -35,6 +35,75 @@ class TC_CoglVertexBuffer < Test::Unit::TestCase
     @vertex_buffer.submit
   end
 
+  def test_add_attribute_array
+    data = Cogl::AttributeArray.new(Cogl::AttributeType::FLOAT, 8)
+    data.set([ 0.0, 0.0, 1.0, 0.0, 1.0, 1.0, 0.0, 1.0 ])
+    assert_equal(@vertex_buffer.add("gl_Vertex", 2,
+                                    Cogl::AttributeType::FLOAT,
+                                    false,
+                                    0,
+                                    data), @vertex_buffer)
+    @vertex_buffer.submit
+  end
+
+  def test_add_attribute_array_wrong_type
+    data = Cogl::AttributeArray.new(Cogl::AttributeType::SHORT, 8)
+    @vertex_buffer.add("gl_Vertex", 2,
+                       Cogl::AttributeType::FLOAT,
+                       false,
+                       0,
+                       data)
+    assert_raise(ArgumentError) do
+      @vertex_buffer.submit
+    end
+  end
+
+  def test_update
+    data = Cogl::AttributeArray.new(Cogl::AttributeType::FLOAT, 8)
+    @vertex_buffer.add("gl_Vertex", 2, Cogl::AttributeType::FLOAT,
+                       false, 0, data)
+    @vertex_buffer.submit
+    assert_equal(@vertex_buffer.update("gl_Vertex", 2, 2,
+                                       [ 1.0, 1.0, 0.0, 1.0 ]),
+                 @vertex_buffer)
+    assert_equal(data.to_a, [ 0.0, 0.0, 0.0, 0.0, 1.0, 1.0, 0.0, 1.0 ])
+    @vertex_buffer.submit
+    assert_raise(ArgumentError) do
+      @vertex_buffer.update("gl_Vertex", 3, 2, [ 1.0, 1.0, 0.0, 1.0 ])
+    end
+    assert_raise(ArgumentError) do
+      @vertex_buffer.update("gl_Color", 0, 1, [ 1.0, 1.0 ])
+    end
+  end
+
+  def test_add_layout
+    layout = Cogl::VertexLayout.new(4)
+    layout.add("gl_Vertex", 2, Cogl::AttributeType::FLOAT)
+    layout.add("gl_Color", 4, Cogl::AttributeType::UNSIGNED_BYTE, true)
+    assert_equal(layout.stride, 12)
+    assert_equal(layout.offset("gl_Color"), 8)
+    layout.set("gl_Vertex", [ 0.0, 0.0, 1.0, 0.0, 1.0, 1.0, 0.0, 1.0 ])
+    layout.set("gl_Color", [ 255 ] * 16)
+    assert_raise(ArgumentError) { layout.set("gl_Vertex", [ 1.0, 1.0 ], 4) }
+    assert_raise(RuntimeError) do
+      layout.add("gl_MultiTexCoord0", 2, Cogl::AttributeType::FLOAT)
+    end
+    assert_equal(@vertex_buffer.add_layout(layout), @vertex_buffer)
+    @vertex_buffer.submit
+  end
+
+  def test_attribute_array_access
+    data = Cogl::AttributeArray.new(Cogl::AttributeType::UNSIGNED_BYTE,
+                                    [ 1, 2, 3, 4 ])
+    assert_equal(data.length, 4)
+    assert_equal(data.bytesize, 4)
+    data[1] = 42
+    data.set(2, "\x05\x06")
+    assert_equal(data.to_a, [ 1, 42, 5, 6 ])
+    assert_raise(ArgumentError) { data[4] }
+    assert_raise(ArgumentError) { data.set(3, [ 1, 2 ]) }
+  end
+
   def test_add_string_short
     assert_equal(@vertex_buffer.add("gl_Vertex", 2,
                                     Cogl::AttributeType::UNSIGNED_BYTE,
@@ -129,4 +198,19 @@ class TC_CoglVertexBuffer < Test::Unit::TestCase
                                               0, 3,
                                               0, 4), @vertex_buffer)
   end
+
+  def test_draw_batch
+    add_test_attribute
+    batch = Cogl::VertexBuffer::Batch.new
+    batch.add(@vertex_buffer, Cogl::VerticesMode::TRIANGLE_STRIP)
+    batch.add(@vertex_buffer, Cogl::VerticesMode::TRIANGLE_FAN, 0, 3,
+              Cogl::VertexBuffer::Indices.get_for_quads(4),
+              Cogl::Material.new)
+    assert_equal(batch.size, 2)
+    assert_raise(ArgumentError) do
+      batch.add(@vertex_buffer, Cogl::VerticesMode::TRIANGLE_STRIP, 0, 5)
+    end
+    assert_equal(Cogl::VertexBuffer.draw_batch(batch), Cogl::VertexBuffer)
+    assert_equal(batch.clear.size, 0)
+  end
 end
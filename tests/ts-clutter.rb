@@ -2,3 +2,14 @@ require 'test/unit'
 $:.unshift File.join(File.dirname(__FILE__))
 
 require 'tc-clutter-text.rb'
+require 'tc-clutter-curve.rb'
+require 'tc-clutter-columnar-model.rb'
+require 'tc-clutter-list-view.rb'
+require 'tc-clutter-container.rb'
+require 'tc-clutter-stats.rb'
+require 'tc-clutter-timeline-group.rb'
+require 'tc-clutter-interval.rb'
+require 'tc-clutter-spatial-index.rb'
+require 'tc-clutter-animate-many.rb'
+require 'tc-clutter-stage-capture.rb'
+require 'tc-clutter-offscreen-renderer.rb'
@@ -3,3 +3,7 @@ $:.unshift File.join(File.dirname(__FILE__))
 
 require 'tc-cogl-texture.rb'
 require 'tc-cogl-vertex-buffer.rb'
+require 'tc-cogl-path.rb'
+require 'tc-cogl-matrix.rb'
+require 'tc-cogl-matrix-array.rb'
+require 'tc-cogl-vector3.rb'